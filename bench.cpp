@@ -0,0 +1,879 @@
+#include "./meta_structure.hpp"
+#include "./meta_soa_vector.hpp"
+#include "./meta_json.hpp"
+#include "./meta_csv.hpp"
+#include "./meta_parallel.hpp"
+#include "./meta_atomic.hpp"
+#include "./meta_any.hpp"
+#include "./meta_patch.hpp"
+#include "./meta_pmr.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// every allocation of the program is counted
+static std::size_t allocations = 0;
+
+// none of them is inlined, or gcc sees the memory of `malloc` released by `operator delete`, or the memory of `operator new` by `free`
+[[gnu::noinline]] void* operator new( std::size_t size )
+{
+    ++allocations;
+    if ( void* ptr = std::malloc( size == 0 ? 1 : size ) ) return ptr;
+    throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void* operator new( std::size_t size, std::align_val_t alignment )
+{
+    ++allocations;
+    if ( void* ptr = std::aligned_alloc( static_cast<std::size_t>( alignment ), ( size + static_cast<std::size_t>( alignment ) - 1 ) / static_cast<std::size_t>( alignment ) * static_cast<std::size_t>( alignment ) ) ) return ptr;
+    throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void operator delete( void* ptr ) noexcept { std::free( ptr ); }
+[[gnu::noinline]] void operator delete( void* ptr, std::size_t ) noexcept { std::free( ptr ); }
+[[gnu::noinline]] void operator delete( void* ptr, std::align_val_t ) noexcept { std::free( ptr ); }
+[[gnu::noinline]] void operator delete( void* ptr, std::size_t, std::align_val_t ) noexcept { std::free( ptr ); }
+
+// prevents the optimizer from discarding a computed value
+template< typename T >
+void keep( T const& value )
+{
+    asm volatile( "" : : "r,m"( value ) : "memory" );
+}
+
+// nanoseconds per call of `function`, best of `rounds`
+template< typename F >
+double time_ns( std::size_t iterations, F&& function, int rounds = 5 )
+{
+    double best = 1.0e100;
+    for ( int round = 0; round < rounds; ++round )
+    {
+        auto const start = std::chrono::steady_clock::now();
+        for ( std::size_t index = 0; index < iterations; ++index )
+            function();
+        auto const stop = std::chrono::steady_clock::now();
+        best = std::min( best, std::chrono::duration<double, std::nano>( stop - start ).count() / iterations );
+    }
+    return best;
+}
+
+// allocations per call of `function`
+template< typename F >
+double allocations_per_call( std::size_t iterations, F&& function )
+{
+    std::size_t const before = allocations;
+    for ( std::size_t index = 0; index < iterations; ++index )
+        function();
+    return static_cast<double>( allocations - before ) / iterations;
+}
+
+void report( std::string const& name, double ns )
+{
+    std::cout << std::left << std::setw( 56 ) << name << std::right << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << ns << " ns/op" << std::endl;
+}
+
+void report( std::string const& name, double ns, double allocs )
+{
+    std::cout << std::left << std::setw( 56 ) << name << std::right << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << ns << " ns/op"
+              << std::setw( 10 ) << std::setprecision( 2 ) << allocs << " allocs/op" << std::endl;
+}
+
+void report_rate( std::string const& name, double mb_per_s )
+{
+    std::cout << std::left << std::setw( 56 ) << name << std::right << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << mb_per_s << " MB/s" << std::endl;
+}
+
+// times `function` and counts its allocations
+template< typename F >
+void measure( std::string const& name, F&& function )
+{
+    std::size_t const iterations = 1 << 16;
+    double const allocs = allocations_per_call( iterations, function );
+    report( name, time_ns( iterations, function ), allocs );
+}
+
+// hand-written aggregates of W fields of type T, the baseline of the meta-structures with the same fields
+template< std::size_t W, typename T >
+struct plain;
+
+template< typename T >
+struct plain<2, T> { T f0, f1; };
+
+template< typename T >
+struct plain<4, T> { T f0, f1, f2, f3; };
+
+template< typename T >
+struct plain<8, T> { T f0, f1, f2, f3, f4, f5, f6, f7; };
+
+template< typename T >
+struct plain<16, T> { T f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15; };
+
+template< typename T > T& middle( plain<4, T>& p ) { return p.f2; }
+template< typename T > T& middle( plain<8, T>& p ) { return p.f4; }
+template< typename T > T& middle( plain<16, T>& p ) { return p.f8; }
+
+int bump( int value ) { return value + 1; }
+std::string bump( std::string const& value ) { return value + "y"; }
+
+template< typename T >
+plain<4, T> bumped( plain<4, T> const& p ) { return { bump( p.f0 ), bump( p.f1 ), bump( p.f2 ), bump( p.f3 ) }; }
+
+template< typename T >
+plain<8, T> bumped( plain<8, T> const& p ) { return { bump( p.f0 ), bump( p.f1 ), bump( p.f2 ), bump( p.f3 ), bump( p.f4 ), bump( p.f5 ), bump( p.f6 ), bump( p.f7 ) }; }
+
+template< typename T >
+plain<16, T> bumped( plain<16, T> const& p )
+{
+    return { bump( p.f0 ), bump( p.f1 ), bump( p.f2 ), bump( p.f3 ), bump( p.f4 ), bump( p.f5 ), bump( p.f6 ), bump( p.f7 ),
+             bump( p.f8 ), bump( p.f9 ), bump( p.f10 ), bump( p.f11 ), bump( p.f12 ), bump( p.f13 ), bump( p.f14 ), bump( p.f15 ) };
+}
+
+template< typename T >
+plain<4, T> join( plain<2, T> const& a, plain<2, T> const& b ) { return { a.f0, a.f1, b.f0, b.f1 }; }
+
+template< typename T >
+plain<8, T> join( plain<4, T> const& a, plain<4, T> const& b ) { return { a.f0, a.f1, a.f2, a.f3, b.f0, b.f1, b.f2, b.f3 }; }
+
+template< typename T >
+plain<16, T> join( plain<8, T> const& a, plain<8, T> const& b ) { return { a.f0, a.f1, a.f2, a.f3, a.f4, a.f5, a.f6, a.f7, b.f0, b.f1, b.f2, b.f3, b.f4, b.f5, b.f6, b.f7 }; }
+
+template< std::size_t W, typename T >
+plain<W, T> make_plain( T const& value )
+{
+    return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) { return plain<W, T>{ ( void(Is), value )... }; }( std::make_index_sequence<W>{} );
+}
+
+// tag "f0", "f1", ... of the I-th field
+template< std::size_t I >
+constexpr auto field_tag() noexcept
+{
+    if constexpr ( I < 10 )
+        return meta::fixed_string<2>{ { 'f', char( '0' + I ), '\0' } };
+    else if constexpr ( I < 100 )
+        return meta::fixed_string<3>{ { 'f', char( '0' + I / 10 ), char( '0' + I % 10 ), '\0' } };
+    else
+        return meta::fixed_string<4>{ { 'f', char( '0' + I / 100 ), char( '0' + I / 10 % 10 ), char( '0' + I % 10 ), '\0' } };
+}
+
+// a meta-structure with the fields [First, First+W) of type T
+template< std::size_t First, std::size_t W, typename T >
+auto make_meta( T const& value )
+{
+    return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) { return meta::create_struct( meta::make_member<field_tag<First + Is>()>( value )... ); }( std::make_index_sequence<W>{} );
+}
+
+// read, update, map and concatenate of a meta-structure of W fields, next to the same operation on a hand-written aggregate
+template< std::size_t W, typename T >
+void bench_width( std::string const& type_name, T const& value )
+{
+    using namespace meta;
+    constexpr auto tag = field_tag<W/2>();
+    std::string const fields = ", " + std::to_string( W ) + " " + type_name + " fields";
+
+    auto s = make_meta<0, W>( value );
+    auto p = make_plain<W>( value );
+    auto const s_low = make_meta<0, W/2>( value );
+    auto const s_high = make_meta<W/2, W/2>( value );
+    auto const p_low = make_plain<W/2>( value );
+    auto const p_high = make_plain<W/2>( value );
+
+    measure( "read_struct" + fields, [&]() { keep( read_struct<tag>( s ) ); } );
+    measure( "  hand-written" + fields, [&]() { keep( middle( p ) ); } );
+    measure( "update_struct (copy)" + fields, [&]() { keep( update_struct<tag>( s, value ) ); } );
+    measure( "  hand-written" + fields, [&]() { auto q = p; middle( q ) = value; keep( q ); } );
+    measure( "update_struct (move)" + fields, [&]() { s = update_struct<tag>( std::move(s), value ); keep( s ); } );
+    measure( "  hand-written" + fields, [&]() { middle( p ) = value; keep( p ); } );
+    measure( "map_struct" + fields, [&]() { keep( map_struct( s, []<Member M>( M const& member ) { return bump( member.value() ); } ) ); } );
+    measure( "  hand-written" + fields, [&]() { keep( bumped( p ) ); } );
+    measure( "concatenate_struct" + fields, [&]() { keep( concatenate_struct( s_low, s_high ) ); } );
+    measure( "  hand-written" + fields, [&]() { keep( join( p_low, p_high ) ); } );
+}
+
+// update_fields and delete_fields of half of the fields, against as many chained update_struct and delete_struct calls, and a lazy chain
+template< typename T >
+void bench_fields( std::string const& type_name, T const& value )
+{
+    using namespace meta;
+    std::string const fields = ", 8 of 16 " + type_name + " fields";
+    auto const s = make_meta<0, 16>( value );
+
+    measure( "update_fields" + fields, [&]()
+    {
+        keep( update_fields( s, make_member<"f0">( value ), make_member<"f2">( value ), make_member<"f4">( value ), make_member<"f6">( value ),
+                                make_member<"f8">( value ), make_member<"f10">( value ), make_member<"f12">( value ), make_member<"f14">( value ) ) );
+    } );
+    measure( "  chained update_struct" + fields, [&]()
+    {
+        keep( update_struct<"f14">( update_struct<"f12">( update_struct<"f10">( update_struct<"f8">( update_struct<"f6">( update_struct<"f4">( update_struct<"f2">( update_struct<"f0">(
+                  s, value ), value ), value ), value ), value ), value ), value ), value ) );
+    } );
+    measure( "  lazy update chain" + fields, [&]()
+    {
+        keep( s.lazy().template update<"f0">( value ).template update<"f2">( value ).template update<"f4">( value ).template update<"f6">( value )
+                      .template update<"f8">( value ).template update<"f10">( value ).template update<"f12">( value ).template update<"f14">( value ).materialize() );
+    } );
+    measure( "delete_fields" + fields, [&]() { keep( delete_fields<"f0", "f2", "f4", "f6", "f8", "f10", "f12", "f14">( s ) ); } );
+    measure( "  chained delete_struct" + fields, [&]()
+    {
+        keep( delete_struct<"f14">( delete_struct<"f12">( delete_struct<"f10">( delete_struct<"f8">( delete_struct<"f6">( delete_struct<"f4">( delete_struct<"f2">( delete_struct<"f0">( s ) ) ) ) ) ) ) ) );
+    } );
+}
+
+template< typename T >
+void bench_crud( std::string const& type_name, T const& value )
+{
+    std::cout << std::endl << "bench CRUD, " << type_name << " fields" << std::endl;
+    bench_width<4>( type_name, value );
+    bench_width<8>( type_name, value );
+    bench_width<16>( type_name, value );
+    bench_fields( type_name, value );
+}
+
+// a counter and an accumulator of a structure with a string buffer, updated in place by ref against rebuilt by update_struct
+void bench_mutable()
+{
+    std::cout << std::endl << "bench REF" << std::endl;
+    using namespace meta;
+
+    auto s = create_struct( make_member<"count">( 0L ), make_member<"sum">( 0.0 ), make_member<"buffer">( std::string( 64, 'b' ) ) );
+    measure( "update_struct of a counter and a sum", [&]()
+    {
+        s = update_struct<"sum">( update_struct<"count">( std::move( s ), s.read<"count">() + 1 ), s.read<"sum">() + 0.5 );
+        keep( s );
+    } );
+    measure( "ref to a counter and a sum", [&]()
+    {
+        ++s.ref<"count">();
+        s.ref<"sum">() += 0.5;
+        keep( s );
+    } );
+}
+
+// a checksum kept up to date by update_struct against a computed member, which is recomputed only when read after a change
+void bench_computed()
+{
+    std::cout << std::endl << "bench COMPUTED" << std::endl;
+    using namespace meta;
+
+    std::vector<int> const data( 1024, 3 );
+    auto const checksum = []( std::vector<int> const& values ) { return std::accumulate( values.begin(), values.end(), 0 ); };
+    auto eager = create_struct( make_member<"data">( data ), make_member<"checksum">( checksum( data ) ) );
+    auto lazy = create_struct( make_member<"data">( data ), make_computed_member<"checksum", "data">( checksum ) );
+    int round = 0;
+    measure( "update_struct, checksum recomputed eagerly", [&]()
+    {
+        eager.ref<"data">()[0] = ++round;
+        eager = update_struct<"checksum">( std::move( eager ), checksum( eager.read<"data">() ) );
+        keep( eager );
+    } );
+    measure( "ref, computed checksum never read", [&]()
+    {
+        lazy.ref<"data">()[0] = ++round;
+        keep( lazy );
+    } );
+    measure( "ref, computed checksum read once per update", [&]()
+    {
+        lazy.ref<"data">()[0] = ++round;
+        keep( lazy.read<"checksum">() );
+    } );
+}
+
+// visit_field against an if/else chain over every tag, with field names known at runtime only
+void bench_visit_field()
+{
+    std::cout << std::endl << "bench VISIT_FIELD" << std::endl;
+    using namespace meta;
+
+    constexpr std::size_t fields = 200;
+    auto const s = make_meta<0, fields>( 1 );
+
+    // every field once, and some missing ones, in a fixed shuffled order
+    std::vector<std::string> names;
+    for ( std::string_view tag : detail::storage_traits<decltype(s.s_)>::tags )
+        names.emplace_back( tag );
+    for ( std::size_t index = 0; index < fields / 10; ++index )
+        names.push_back( "missing" + std::to_string( index ) );
+    std::shuffle( names.begin(), names.end(), std::mt19937{ 42 } );
+
+    std::size_t next = 0;
+    int sum = 0;
+    double const hashed = time_ns( 1 << 16, [&]()
+    {
+        std::string const& name = names[next++ % names.size()];
+        visit_field( s, name, [&]<Member M>( M const& member ) { sum += member.value(); } );
+        keep( sum );
+    } );
+    double const chained = time_ns( 1 << 16, [&]()
+    {
+        std::string const& name = names[next++ % names.size()];
+        [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+        {
+            ( ( name == field_tag<Is>().view() ? ( sum += read_struct<field_tag<Is>()>( s ), true ) : false ) || ... );
+        }( std::make_index_sequence<fields>{} );
+        keep( sum );
+    } );
+
+    report( "visit_field, 200 fields", hashed );
+    report( "if/else chain over the tags, 200 fields", chained );
+}
+
+// map_columns against a loop of map_struct calls over the same records
+void bench_map_columns()
+{
+    std::cout << std::endl << "bench MAP_COLUMNS" << std::endl;
+    using namespace meta;
+
+    std::size_t const records = 1 << 18;
+    auto const prototype = create_struct( make_member<"x">( 1.0f ), make_member<"y">( 2.0 ), make_member<"id">( 3 ), make_member<"w">( 4.0f ) );
+    auto const scale = []<Member M>( M const& member ) { return member.value() * 2 + 1; };
+
+    std::vector<std::remove_cvref_t<decltype(prototype)>> aos( records, prototype );
+    soa_vector soa{ prototype };
+    soa.reserve( records );
+    for ( std::size_t index = 0; index < records; ++index )
+        soa.push_back( prototype );
+
+    double const naive = time_ns( 1, [&]()
+    {
+        for ( auto& record : aos )
+            record = map_struct( record, scale );
+        keep( aos.front() );
+    } );
+    double const batched = time_ns( 1, [&]()
+    {
+        map_columns( soa, scale );
+        keep( soa.col<"x">()[0] );
+    } );
+
+    report( "map_struct loop, 4 numeric fields, per record", naive / records );
+    report( "map_columns, 4 numeric fields, per record", batched / records );
+}
+
+// a generic JSON document, as built by a DOM library: every value is a node, every object a list of named nodes
+struct dom_node
+{
+    double number = 0;
+    bool boolean = false;
+    std::string text;
+    std::vector<dom_node> items;
+    std::vector<std::pair<std::string, dom_node>> fields;
+
+    dom_node const& at( std::string_view key ) const
+    {
+        return std::find_if( fields.begin(), fields.end(), [&]( auto const& field ) { return field.first == key; } )->second;
+    }
+};
+
+void dom_space( char const*& it ) { while ( *it == ' ' || *it == '\n' || *it == '\r' || *it == '\t' ) ++it; }
+
+std::string dom_string( char const*& it )
+{
+    std::string ans;
+    for ( ++it; *it != '"'; ++it )
+        ans += *it == '\\' ? ( ++it, *it == 'n' ? '\n' : *it ) : *it;
+    ++it;
+    return ans;
+}
+
+dom_node dom_parse( char const*& it )
+{
+    dom_node node;
+    dom_space( it );
+    if ( *it == '{' )
+    {
+        for ( ++it, dom_space( it ); *it != '}'; dom_space( it ) )
+        {
+            dom_space( it );
+            std::string key = dom_string( it );
+            dom_space( it );
+            ++it; // ':'
+            node.fields.emplace_back( std::move( key ), dom_parse( it ) );
+            dom_space( it );
+            if ( *it == ',' ) ++it;
+        }
+        ++it;
+    }
+    else if ( *it == '[' )
+    {
+        for ( ++it, dom_space( it ); *it != ']'; dom_space( it ) )
+        {
+            node.items.push_back( dom_parse( it ) );
+            dom_space( it );
+            if ( *it == ',' ) ++it;
+        }
+        ++it;
+    }
+    else if ( *it == '"' )
+        node.text = dom_string( it );
+    else if ( *it == 't' || *it == 'f' )
+    {
+        node.boolean = *it == 't';
+        it += node.boolean ? 4 : 5;
+    }
+    else
+    {
+        char* last = nullptr;
+        node.number = std::strtod( it, &last );
+        it = last;
+    }
+    return node;
+}
+
+// from_json and to_json against a generic DOM copied field by field into update_struct calls, and an ostringstream
+void bench_json()
+{
+    std::cout << std::endl << "bench JSON" << std::endl;
+    using namespace meta;
+
+    auto const prototype = create_struct( make_member<"id">( 0 ), make_member<"name">( std::string{} ), make_member<"price">( 0.0 ), make_member<"quantity">( 0 ),
+                                          make_member<"active">( false ), make_member<"ratio">( 0.0 ), make_member<"comment">( std::string{} ), make_member<"scores">( std::vector<double>{} ) );
+    using record = std::remove_cvref_t<decltype(prototype)>;
+
+    std::size_t const records = 1024;
+    std::mt19937 engine{ 42 };
+    std::uniform_real_distribution<double> real{ -1.0e6, 1.0e6 };
+    std::vector<std::string> texts;
+    std::size_t bytes = 0;
+    for ( std::size_t index = 0; index < records; ++index )
+    {
+        auto const r = prototype.update<"id">( int( index ) ).update<"name">( "item \"" + std::to_string( index ) + "\"" ).update<"price">( real( engine ) )
+                                .update<"quantity">( int( engine() % 1000 ) ).update<"active">( index % 2 == 0 ).update<"ratio">( real( engine ) / 3.0 )
+                                .update<"comment">( std::string( 16 + index % 48, 'c' ) ).update<"scores">( std::vector<double>{ real( engine ), real( engine ), real( engine ) } );
+        texts.push_back( to_json( r ) );
+        bytes += texts.back().size();
+    }
+    double const megabytes = bytes / 1.0e6;
+
+    record parsed = prototype;
+    double const generated = time_ns( 1, [&]()
+    {
+        for ( std::string const& text : texts )
+            from_json( text, parsed );
+        keep( parsed );
+    } );
+    double const dom = time_ns( 1, [&]()
+    {
+        for ( std::string const& text : texts )
+        {
+            char const* it = text.c_str();
+            dom_node const node = dom_parse( it );
+            auto const& fields = node;
+            std::vector<double> scores;
+            for ( auto const& item : fields.at( "scores" ).items )
+                scores.push_back( item.number );
+            auto const r = prototype.update<"id">( int( fields.at( "id" ).number ) ).update<"name">( fields.at( "name" ).text ).update<"price">( fields.at( "price" ).number )
+                                    .update<"quantity">( int( fields.at( "quantity" ).number ) ).update<"active">( fields.at( "active" ).boolean ).update<"ratio">( fields.at( "ratio" ).number )
+                                    .update<"comment">( fields.at( "comment" ).text ).update<"scores">( std::move( scores ) );
+            keep( r );
+        }
+    } );
+
+    std::string out;
+    double const written = time_ns( 1, [&]()
+    {
+        for ( std::size_t index = 0; index < records; ++index )
+        {
+            out.clear();
+            to_json( parsed, out );
+            keep( out );
+        }
+    } );
+    double const streamed = time_ns( 1, [&]()
+    {
+        for ( std::size_t index = 0; index < records; ++index )
+        {
+            std::ostringstream stream;
+            stream.precision( 17 );
+            stream << "{\"id\":" << parsed.read<"id">() << ",\"name\":\"" << parsed.read<"name">() << "\",\"price\":" << parsed.read<"price">() << ",\"quantity\":" << parsed.read<"quantity">()
+                   << ",\"active\":" << ( parsed.read<"active">() ? "true" : "false" ) << ",\"ratio\":" << parsed.read<"ratio">() << ",\"comment\":\"" << parsed.read<"comment">() << "\",\"scores\":[";
+            for ( std::size_t item = 0; item < parsed.read<"scores">().size(); ++item )
+                stream << ( item ? "," : "" ) << parsed.read<"scores">()[item];
+            stream << "]}";
+            keep( stream.str() );
+        }
+    } );
+
+    report_rate( "from_json, 8 fields", megabytes / ( generated * 1.0e-9 ) );
+    report_rate( "  generic DOM, then update_struct per field", megabytes / ( dom * 1.0e-9 ) );
+    report_rate( "to_json, 8 fields", out.size() * records / 1.0e6 / ( written * 1.0e-9 ) );
+    report_rate( "  ostringstream, field by field", out.size() * records / 1.0e6 / ( streamed * 1.0e-9 ) );
+}
+
+// load_csv from a file, by one thread and by every hardware thread (at least two), against a getline loop converting field by field into push_back
+void bench_csv()
+{
+    std::cout << std::endl << "bench CSV" << std::endl;
+    using namespace meta;
+
+    auto const prototype = create_struct( make_member<"id">( 0 ), make_member<"name">( std::string{} ), make_member<"price">( 0.0 ), make_member<"quantity">( 0 ), make_member<"ratio">( 0.0f ) );
+    using record = std::remove_cvref_t<decltype(prototype)>;
+
+    std::mt19937 engine{ 42 };
+    std::uniform_real_distribution<double> real{ 0.0, 1.0e4 };
+    std::string text = "id,name,price,quantity,ratio\n";
+    for ( int index = 0; index < ( 1 << 20 ); ++index )
+        text += std::to_string( index ) + ",item" + std::to_string( engine() % 100000 ) + "," + std::to_string( real( engine ) ) + "," + std::to_string( engine() % 1000 ) + "," + std::to_string( real( engine ) / 1.0e4 ) + "\n";
+    std::filesystem::path const path = std::filesystem::temp_directory_path() / "meta_structure_bench.csv";
+    std::ofstream( path ) << text;
+    double const megabytes = text.size() / 1.0e6;
+
+    unsigned const threads = std::max( 2U, std::thread::hardware_concurrency() );
+    double const single = time_ns( 1, [&]() { soa_vector<record> v; load_csv( path, v ); keep( v.size() ); }, 3 );
+    double const parallel = time_ns( 1, [&]() { soa_vector<record> v; load_csv( path, v, csv_options{ .threads = threads } ); keep( v.size() ); }, 3 );
+    double const naive = time_ns( 1, [&]()
+    {
+        soa_vector<record> v;
+        std::ifstream file( path );
+        std::string line;
+        std::getline( file, line );
+        while ( std::getline( file, line ) )
+        {
+            std::istringstream fields( line );
+            std::string id, name, price, quantity, ratio;
+            std::getline( fields, id, ',' );
+            std::getline( fields, name, ',' );
+            std::getline( fields, price, ',' );
+            std::getline( fields, quantity, ',' );
+            std::getline( fields, ratio, ',' );
+            v.push_back( prototype.update<"id">( std::stoi( id ) ).update<"name">( name ).update<"price">( std::stod( price ) ).update<"quantity">( std::stoi( quantity ) ).update<"ratio">( std::stof( ratio ) ) );
+        }
+        keep( v.size() );
+    }, 3 );
+    std::filesystem::remove( path );
+
+    report_rate( "load_csv, 5 fields, 1 thread", megabytes / ( single * 1.0e-9 ) );
+    report_rate( "load_csv, 5 fields, " + std::to_string( threads ) + " threads", megabytes / ( parallel * 1.0e-9 ) );
+    report_rate( "  getline, then update_struct per field", megabytes / ( naive * 1.0e-9 ) );
+}
+
+void bench_parallel_map()
+{
+    std::cout << std::endl << "bench PARALLEL_MAP" << std::endl;
+    using namespace meta;
+
+    std::mt19937 engine{ 42 };
+    auto const payload = [&]() { std::vector<double> values( 1 << 18 ); for ( auto& value : values ) value = engine(); return values; };
+    auto const s = create_struct( make_member<"a">( payload() ), make_member<"b">( payload() ), make_member<"c">( payload() ), make_member<"d">( payload() ),
+                                  make_member<"e">( payload() ), make_member<"f">( payload() ), make_member<"g">( payload() ), make_member<"h">( payload() ),
+                                  make_member<"id">( 0 ) );
+    // an expensive map per field: a sorted copy of the payload
+    auto const sorted = []<Member M>( M const& member )
+    {
+        auto value = member.value();
+        if constexpr ( !std::is_arithmetic_v<typename M::value_type> ) std::sort( value.begin(), value.end() );
+        return value;
+    };
+
+    report( "map_struct, 8 x 256K doubles sorted", time_ns( 1, [&]() { keep( map_struct( s, sorted ).read<"a">().front() ); }, 3 ) );
+    for ( unsigned threads : { 1U, 2U, 4U, 8U } )
+    {
+        thread_pool pool{ threads };
+        report( "parallel_map_struct, " + std::to_string( threads ) + " threads", time_ns( 1, [&]() { keep( parallel_map_struct( s, sorted, pool ).read<"a">().front() ); }, 3 ) );
+    }
+}
+
+// reads per second of `read` called by `readers` threads during 100ms, while `write` is called in a loop
+template< typename R, typename W >
+double reads_per_second( unsigned readers, R&& read, W&& write )
+{
+    std::atomic<bool> stop{ false };
+    std::atomic<std::size_t> reads{ 0 };
+    {
+        std::vector<std::jthread> threads;
+        for ( unsigned index = 0; index < readers; ++index )
+            threads.emplace_back( [&]()
+            {
+                std::size_t count = 0;
+                for ( ; !stop.load( std::memory_order_relaxed ); ++count )
+                    read();
+                reads += count;
+            } );
+        threads.emplace_back( [&]()
+        {
+            while ( !stop.load( std::memory_order_relaxed ) )
+            {
+                write();
+                std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+            }
+        } );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+        stop = true;
+    }
+    return reads / 0.1;
+}
+
+void bench_atomic_struct()
+{
+    std::cout << std::endl << "bench ATOMIC_STRUCT" << std::endl;
+    using namespace meta;
+
+    auto const prototype = create_struct( make_member<"threads">( 8 ), make_member<"ratio">( 0.5 ), make_member<"name">( std::string( 32, 'x' ) ),
+                                          make_member<"table">( std::vector<double>( 4096, 1.0 ) ) );
+    atomic_struct shared{ prototype };
+    auto locked = prototype;
+    std::mutex mutex;
+    int version = 0;
+
+    for ( unsigned readers : { 1U, 2U, 4U, 8U, 16U, 32U, 64U } )
+    {
+        double const rcu = reads_per_second( readers, [&]() { auto const s = shared.snapshot(); keep( s.read<"threads">() + s.read<"table">()[7] ); },
+                                             [&]() { shared.publish( make_member<"threads">( ++version ) ); } );
+        double const copy = reads_per_second( readers, [&]() { auto const s = [&]() { std::lock_guard lock{ mutex }; return locked; }(); keep( s.read<"threads">() + s.read<"table">()[7] ); },
+                                              [&]() { std::lock_guard lock{ mutex }; locked = locked.update<"threads">( ++version ); } );
+        std::cout << std::left << std::setw( 56 ) << ( "snapshot, " + std::to_string( readers ) + " readers" ) << std::right << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << rcu / 1.0e6 << " M reads/s" << std::endl;
+        std::cout << std::left << std::setw( 56 ) << "  mutex, then copy" << std::right << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << copy / 1.0e6 << " M reads/s" << std::endl;
+    }
+}
+
+// the same two shapes, as classes with virtual functions
+struct virtual_shape
+{
+    virtual ~virtual_shape() = default;
+    virtual double area() const = 0;
+};
+
+struct virtual_square : virtual_shape
+{
+    double side;
+    explicit virtual_square( double s ) : side( s ) {}
+    double area() const override { return side * side; }
+};
+
+struct virtual_circle : virtual_shape
+{
+    double radius;
+    explicit virtual_circle( double r ) : radius( r ) {}
+    double area() const override { return 3.14159 * radius * radius; }
+};
+
+void bench_any_struct()
+{
+    std::cout << std::endl << "bench ANY_STRUCT" << std::endl;
+    using namespace meta;
+
+    using shape = interface<method<"area", double()>>;
+    std::size_t const count = 1024;
+    std::mt19937 engine{ 42 };
+    std::vector<any_struct<shape>> erased;
+    std::vector<std::unique_ptr<virtual_shape>> virtuals;
+    std::vector<std::function<double()>> functions;
+    for ( std::size_t index = 0; index < count; ++index )
+    {
+        double const size = 1.0 + index % 7;
+        if ( engine() % 2 )
+        {
+            erased.emplace_back( create_struct( make_member<"area">( [size]() { return size * size; } ) ) );
+            virtuals.push_back( std::make_unique<virtual_square>( size ) );
+            functions.emplace_back( [size]() { return size * size; } );
+        }
+        else
+        {
+            erased.emplace_back( create_struct( make_member<"area">( [size]() { return 3.14159 * size * size; } ) ) );
+            virtuals.push_back( std::make_unique<virtual_circle>( size ) );
+            functions.emplace_back( [size]() { return 3.14159 * size * size; } );
+        }
+    }
+
+    auto const total = [&]( auto const& shapes, auto&& area ) { double sum = 0.0; for ( auto const& s : shapes ) sum += area( s ); keep( sum ); };
+    report( "any_struct::call, 1024 shapes", time_ns( 1 << 10, [&]() { total( erased, []( auto const& s ) { return s.template call<"area">(); } ); } ) / count );
+    report( "  virtual function", time_ns( 1 << 10, [&]() { total( virtuals, []( auto const& s ) { return s->area(); } ); } ) / count );
+    report( "  std::function", time_ns( 1 << 10, [&]() { total( functions, []( auto const& s ) { return s(); } ); } ) / count );
+    report( "any_struct construction", time_ns( 1 << 16, [&]() { keep( any_struct<shape>{ create_struct( make_member<"area">( []() { return 1.0; } ) ) } ); } ),
+            allocations_per_call( 1 << 16, [&]() { keep( any_struct<shape>{ create_struct( make_member<"area">( []() { return 1.0; } ) ) } ); } ) );
+}
+
+void bench_patch()
+{
+    std::cout << std::endl << "bench DIFF/PATCH" << std::endl;
+    using namespace meta;
+
+    auto const before = concatenate_struct( make_meta<0, 40>( 1.0 ), make_meta<40, 10>( std::string( 16, 'x' ) ) );
+    using record = std::remove_cvref_t<decltype(before)>;
+    auto const after = update_struct<field_tag<45>()>( update_struct<field_tag<7>()>( before, 2.0 ), std::string( 16, 'y' ) );
+
+    std::size_t const whole = serialize_struct( after ).size();
+    std::size_t const patched = serialize_patch( diff_struct( before, after ) ).size();
+    std::cout << "50 fields, 2 changed: the structure takes " << whole << " bytes, the patch " << patched << " bytes" << std::endl;
+
+    measure( "serialize_struct, then view_struct and to_struct", [&]()
+    {
+        std::vector<std::byte> const message = serialize_struct( after );
+        keep( view_struct<record>( std::span{ message } )->to_struct() );
+    } );
+    record replica = before;
+    measure( "diff_struct and serialize_patch, then apply_patch", [&]()
+    {
+        std::vector<std::byte> const message = serialize_patch( diff_struct( before, after ) );
+        replica = apply_patch( std::move( replica ), *deserialize_patch<record>( std::span{ message } ) );
+        keep( replica );
+    } );
+    measure( "diff_struct and serialize_patch, then apply_to in place", [&]()
+    {
+        std::vector<std::byte> const message = serialize_patch( diff_struct( before, after ) );
+        deserialize_patch<record>( std::span{ message } )->apply_to( replica );
+        keep( replica );
+    } );
+}
+
+// the baseline of bench_hash_keys, with the usual hand-written equality and hash combine
+struct plain_key
+{
+    std::int32_t venue;
+    std::int32_t side;
+    std::int64_t account;
+    std::int64_t instrument;
+    std::string symbol;
+
+    bool operator == ( plain_key const& ) const = default;
+};
+
+struct plain_key_hash
+{
+    std::size_t operator()( plain_key const& key ) const noexcept
+    {
+        std::size_t hash = std::hash<std::int32_t>{}( key.venue );
+        auto const combine = [&]( std::size_t value ) { hash ^= value + 0x9e3779b9 + ( hash << 6 ) + ( hash >> 2 ); };
+        combine( std::hash<std::int32_t>{}( key.side ) );
+        combine( std::hash<std::int64_t>{}( key.account ) );
+        combine( std::hash<std::int64_t>{}( key.instrument ) );
+        combine( std::hash<std::string>{}( key.symbol ) );
+        return hash;
+    }
+};
+
+void bench_hash_keys()
+{
+    std::cout << std::endl << "bench HASH KEYS" << std::endl;
+    using namespace meta;
+
+    std::size_t const keys = 1 << 14;
+    std::mt19937_64 random{ 42 };
+    std::vector<plain_key> plain_keys;
+    for ( std::size_t index = 0; index != keys; ++index )
+        plain_keys.push_back( plain_key{ static_cast<std::int32_t>( index % 7 ), static_cast<std::int32_t>( index % 2 ), static_cast<std::int64_t>( random() ),
+                                         static_cast<std::int64_t>( random() % 100000 ), "SYM" + std::to_string( random() % 500 ) } );
+    auto const make_key = []( plain_key const& k )
+    {
+        return create_struct( make_member<"venue">( k.venue ), make_member<"side">( k.side ), make_member<"account">( k.account ), make_member<"instrument">( k.instrument ),
+                              make_member<"symbol">( k.symbol ) );
+    };
+    using key = std::remove_cvref_t<decltype(make_key( plain_keys[0] ))>;
+    std::vector<key> meta_keys;
+    for ( plain_key const& k : plain_keys )
+        meta_keys.push_back( make_key( k ) );
+    // looked up in a random order: the keys inserted together are not found together
+    std::vector<std::size_t> order( keys );
+    std::iota( order.begin(), order.end(), std::size_t{0} );
+    std::shuffle( order.begin(), order.end(), std::mt19937{ 42 } );
+    std::cout << "5 fields: 4 integers hashed and compared as one run of bytes, then a string" << std::endl;
+
+    auto const run = [&]( std::string const& name, auto const& samples, auto map )
+    {
+        report( name + ", insert", time_ns( 1, [&]()
+        {
+            map.clear();
+            for ( std::size_t index = 0; index != samples.size(); ++index )
+                map.emplace( samples[index], index );
+        }, 20 ) / keys );
+        report( name + ", find", time_ns( 1, [&]()
+        {
+            std::size_t found = 0;
+            for ( std::size_t index : order )
+                found += map.find( samples[index] )->second;
+            keep( found );
+        }, 20 ) / keys );
+    };
+    run( "std::unordered_map<meta structure>", meta_keys, std::unordered_map<key, std::size_t>{} );
+    run( "std::unordered_map<hand-written struct>", plain_keys, std::unordered_map<plain_key, std::size_t, plain_key_hash>{} );
+    std::sort( meta_keys.begin(), meta_keys.end() );
+    report( "std::sort by operator <=>", time_ns( 1, [&]()
+    {
+        std::vector<key> copy = meta_keys;
+        std::sort( copy.begin(), copy.end(), std::greater<>{} );
+        keep( copy );
+    } ) / keys );
+}
+
+// a request: 4 strings longer than the small string buffer, a list of headers and a status, created, updated twice, then copied to a response
+void bench_arena()
+{
+    std::cout << std::endl << "bench ARENA" << std::endl;
+    using namespace meta;
+
+    std::string_view const path = "/api/v1/structures/0123456789/fields/name?verbose=1";
+    std::string_view const host = "meta-structure.example.com:8443-internal-frontend";
+    std::string_view const agent = "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36";
+    std::string_view const body = "{\"name\": \"meta structure\", \"fields\": [1, 2, 3, 4, 5, 6]}";
+
+    measure( "std::string fields, global heap", [&]()
+    {
+        auto const request = create_struct( make_member<"path">( std::string{ path } ), make_member<"host">( std::string{ host } ), make_member<"agent">( std::string{ agent } ),
+                                            make_member<"body">( std::string{ body } ),
+                                            make_member<"headers">( std::vector<std::string>{ std::string{ host }, std::string{ agent } } ), make_member<"status">( 0 ) );
+        auto const routed = update_struct<"path">( request, std::string{ path.substr( 7 ) } );
+        auto const response = update_struct<"status">( routed, 200 );
+        keep( response.read<"status">() );
+    } );
+
+    struct_arena arena{ 16 * 1024 };
+    measure( "std::pmr::string fields, struct_arena reset per request", [&]()
+    {
+        std::pmr::polymorphic_allocator<> const allocator = arena.get_allocator();
+        {
+            std::pmr::vector<std::pmr::string> headers{ allocator };
+            headers.reserve( 2 );
+            headers.emplace_back( host );
+            headers.emplace_back( agent );
+            auto const request = create_struct( std::allocator_arg, allocator, make_member<"path">( std::pmr::string{ path, allocator } ), make_member<"host">( std::pmr::string{ host, allocator } ),
+                                                make_member<"agent">( std::pmr::string{ agent, allocator } ), make_member<"body">( std::pmr::string{ body, allocator } ),
+                                                make_member<"headers">( std::move( headers ) ), make_member<"status">( 0 ) );
+            auto const routed = update_struct<"path">( std::allocator_arg, allocator, request, std::pmr::string{ path.substr( 7 ), allocator } );
+            auto const response = update_struct<"status">( std::allocator_arg, allocator, routed, 200 );
+            keep( response.read<"status">() );
+        }
+        arena.reset();
+    } );
+    std::cout << "arena: " << arena.capacity() << " bytes, at most " << arena.peak() << " used by a request" << std::endl;
+}
+
+int main()
+{
+    bench_crud<int>( "int", 1 );
+    bench_crud<std::string>( "string", std::string( 32, 'x' ) );
+    bench_mutable();
+    bench_computed();
+    bench_visit_field();
+    bench_map_columns();
+    bench_json();
+    bench_csv();
+    bench_patch();
+    bench_hash_keys();
+    bench_arena();
+    bench_parallel_map();
+    bench_atomic_struct();
+    bench_any_struct();
+
+    return 0;
+}
+
@@ -0,0 +1,152 @@
+// Compile-time benchmark of meta_structure.hpp.
+//
+// For every compiler, operation and field count, a translation unit is generated and compiled to an object file,
+// the wall time, the peak resident set size of the compiler and the size of the object file are written to a CSV.
+//
+// usage: ./compile_bench [output.csv [compiler ...]], by default compile_bench.csv with g++ and clang++
+//        the compilers not installed are skipped, the header is looked up in the current directory.
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct measure
+{
+    bool compiled;
+    double wall_ms;
+    long peak_rss_kb;
+    std::uintmax_t object_bytes;
+};
+
+std::size_t const field_counts[] = { 10, 50, 100, 250, 500 };
+
+char const* const operations[] = { "create", "read", "update", "delete", "has", "map", "upgrade", "concatenate" };
+
+// tag of the I-th field
+std::string tag( std::size_t index )
+{
+    std::string const digits = std::to_string( index );
+    return "f" + std::string( digits.size() < 4 ? 4 - digits.size() : 0, '0' ) + digits;
+}
+
+// a translation unit creating a structure of `fields` int fields and applying `operation` to it
+std::string generate( std::string const& operation, std::size_t fields )
+{
+    std::string const first = tag( 0 );
+    std::string const last = tag( fields - 1 );
+
+    std::string code = "#include \"meta_structure.hpp\"\n\nusing namespace meta;\n\nint bench( int x )\n{\n    auto const s = create_struct\n    (\n";
+    for ( std::size_t index = 0; index < fields; ++index )
+        code += "        make_member<\"" + tag( index ) + "\">( x + " + std::to_string( index ) + " )" + ( index + 1 < fields ? ",\n" : "\n" );
+    code += "    );\n";
+
+    if ( operation == "create" )
+        code += "    return s.read<\"" + first + "\">();\n";
+    else if ( operation == "read" )
+        code += "    return read_struct<\"" + last + "\">( s ) + s.read<\"" + tag( fields / 2 ) + "\">();\n";
+    else if ( operation == "update" )
+        code += "    auto const t = update_struct<\"" + last + "\">( s, 1.0 );\n    return int( t.read<\"" + last + "\">() );\n";
+    else if ( operation == "delete" )
+        code += "    auto const t = delete_struct<\"" + first + "\">( s );\n    return int( t.size() ) + t.read<\"" + last + "\">();\n";
+    else if ( operation == "has" )
+        code += "    return int( struct_has<\"" + last + "\">( s ) ) + int( s.has<\"missing\">() ) + s.read<\"" + first + "\">();\n";
+    else if ( operation == "map" )
+        code += "    auto const t = map_struct( s, []<Member M>( M const& m ) { return m.value() + 1; } );\n    return t.read<\"" + last + "\">();\n";
+    else if ( operation == "upgrade" )
+        code += "    auto const t = upgrade_struct<\"" + last + "\">( s, 2 );\n    return t.read<\"" + last + "\">();\n";
+    else if ( operation == "concatenate" )
+        code += "    auto const t = concatenate_struct( s, create_struct( make_member<\"extra\">( x ) ) );\n    return t.read<\"extra\">();\n";
+    code += "}\n";
+    return code;
+}
+
+// runs `command`, its peak RSS is the largest of the compiler driver and of the processes it has waited for
+measure run( std::vector<std::string> const& command )
+{
+    std::vector<char*> argv;
+    for ( auto const& arg : command )
+        argv.push_back( const_cast<char*>( arg.c_str() ) );
+    argv.push_back( nullptr );
+
+    auto const start = std::chrono::steady_clock::now();
+    pid_t const pid = fork();
+    if ( pid == 0 )
+    {
+        execvp( argv[0], argv.data() );
+        _exit( 127 );
+    }
+    int status = 0;
+    rusage usage{};
+    wait4( pid, &status, 0, &usage );
+    auto const stop = std::chrono::steady_clock::now();
+
+    bool const compiled = pid > 0 && WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+    return measure{ compiled, std::chrono::duration<double, std::milli>( stop - start ).count(), usage.ru_maxrss, 0 };
+}
+
+bool available( std::string const& compiler )
+{
+    return run( { "sh", "-c", "command -v " + compiler + " > /dev/null" } ).compiled;
+}
+
+int main( int argc, char** argv )
+{
+    std::string const output = argc > 1 ? argv[1] : "compile_bench.csv";
+    std::vector<std::string> compilers( argv + std::min( argc, 2 ), argv + argc );
+    if ( compilers.empty() )
+        compilers = { "g++", "clang++" };
+
+    fs::path const include = fs::current_path();
+    fs::path const directory = fs::temp_directory_path() / ( "meta_compile_bench." + std::to_string( getpid() ) );
+    fs::create_directories( directory );
+
+    std::ofstream csv( output );
+    csv << "compiler,operation,fields,wall_ms,peak_rss_kb,object_bytes,compiled\n";
+
+    for ( auto const& compiler : compilers )
+    {
+        if ( !available( compiler ) )
+        {
+            std::cout << "skipping " << compiler << ", not found" << std::endl;
+            continue;
+        }
+        std::cout << std::endl << "compile bench " << compiler << std::endl;
+        std::cout << std::left << std::setw( 14 ) << "operation" << std::right << std::setw( 8 ) << "fields" << std::setw( 12 ) << "wall ms" << std::setw( 14 ) << "peak RSS KB" << std::setw( 14 ) << "object bytes" << std::endl;
+
+        for ( std::string const operation : operations )
+            for ( std::size_t fields : field_counts )
+            {
+                fs::path const source = directory / ( operation + "_" + std::to_string( fields ) + ".cpp" );
+                fs::path const object = directory / ( operation + "_" + std::to_string( fields ) + ".o" );
+                std::ofstream( source ) << generate( operation, fields );
+
+                fs::remove( object );
+                measure m = run( { compiler, "-std=c++20", "-O2", "-c", "-I" + include.string(), source.string(), "-o", object.string() } );
+                if ( m.compiled )
+                    m.object_bytes = fs::file_size( object );
+
+                csv << compiler << ',' << operation << ',' << fields << ',' << std::fixed << std::setprecision( 1 ) << m.wall_ms << ',' << m.peak_rss_kb << ',' << m.object_bytes << ',' << ( m.compiled ? "yes" : "no" ) << '\n' << std::flush;
+                std::cout << std::left << std::setw( 14 ) << operation << std::right << std::setw( 8 ) << fields << std::setw( 12 ) << std::fixed << std::setprecision( 1 ) << m.wall_ms
+                          << std::setw( 14 ) << m.peak_rss_kb << std::setw( 14 ) << m.object_bytes << ( m.compiled ? "" : "  (failed)" ) << std::endl;
+            }
+    }
+
+    fs::remove_all( directory );
+    std::cout << std::endl << "results written to " << output << std::endl;
+
+    return 0;
+}
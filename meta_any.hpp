@@ -0,0 +1,253 @@
+#ifndef META_ANY_HPP_INCLUDED_WERTYUIOPLKJHGFDSAZXCVBNM0192837465MNBVCXZASDF
+#define META_ANY_HPP_INCLUDED_WERTYUIOPLKJHGFDSAZXCVBNM0192837465MNBVCXZASDF
+
+#include "./meta_structure.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace meta
+{
+
+namespace detail
+{
+
+template< fixed_string tag_, Structure S >
+constexpr bool has_field() noexcept
+{
+    using storage_type = std::remove_cvref_t<decltype(std::declval<S const&>().s_)>;
+    return index_of_tag<tag_, storage_type>::value < storage_size<storage_type>::value;
+}
+
+// the type of the field `tag`, or void if the structure does not have it
+template< fixed_string tag_, Structure S >
+constexpr auto field_of() noexcept
+{
+    if constexpr ( has_field<tag_, S>() ) return std::type_identity<decltype(std::declval<S const&>().template read<tag_>())>{};
+    else return std::type_identity<void>{};
+}
+
+template< fixed_string tag_, Structure S >
+using field_of_t = typename decltype( field_of<tag_, S>() )::type;
+
+}//namespace detail
+
+///
+/// @brief A method of an interface: the field `tag` holds a callable, called with `Args...` and returning a value convertible to `R`.
+///
+template< fixed_string tag_, typename Signature >
+struct method;
+
+template< fixed_string tag_, typename R, typename ... Args >
+struct method< tag_, R(Args...) >
+{
+    static constexpr auto tag() noexcept { return tag_; }
+
+    typedef R (*function_type)( void const*, Args... );
+
+    template< typename S >
+    static constexpr bool implemented_by = std::is_invocable_r_v<R, detail::field_of_t<tag_, S>, Args...>;
+
+    template< typename S >
+    static R thunk( void const* object, Args ... args )
+    {
+        return std::invoke( static_cast<S const*>( object )->template read<tag_>(), std::forward<Args>(args)... );
+    }
+};//struct method
+
+///
+/// @brief A field of an interface: the field `tag` holds a `T`, read by reference.
+///
+template< fixed_string tag_, typename T >
+struct property
+{
+    static constexpr auto tag() noexcept { return tag_; }
+
+    typedef T const& (*function_type)( void const* );
+
+    template< typename S >
+    static constexpr bool implemented_by = std::is_same_v<std::remove_cvref_t<detail::field_of_t<tag_, S>>, T>;
+
+    template< typename S >
+    static T const& thunk( void const* object )
+    {
+        return static_cast<S const*>( object )->template read<tag_>();
+    }
+};//struct property
+
+///
+/// @brief A list of `method` and `property`, the fields a structure must have to be stored in an `any_struct`.
+///
+template< typename ... Entries >
+struct interface {};
+
+template< typename S, typename Interface >
+struct implements : std::false_type {};
+
+template< Structure S, typename ... Entries >
+struct implements< S, interface<Entries...> > : std::bool_constant<( Entries::template implemented_by<S> && ... )> {};
+
+template< typename S, typename Interface >
+inline constexpr bool implements_v = implements<S, Interface>::value;
+
+template< typename Interface, std::size_t buffer_size = 4 * sizeof(void*) >
+class any_struct;
+
+///
+/// @brief Any meta structure implementing `interface<Entries...>`, behind one static table of functions per structure type.
+///        A call is one indirect call through the table. A structure up to `buffer_size` bytes, nothrow movable, is stored in place, a larger one on the heap.
+/// Example:
+/// \code{.cpp}
+/// using shape = interface<method<"area", double()>, property<"name", std::string>>;
+/// std::vector<any_struct<shape>> shapes;
+/// shapes.emplace_back( create_struct( make_member<"area">( []() { return 1.0; } ), make_member<"name">( std::string{"unit square"} ) ) );
+/// double const area = shapes[0].call<"area">();
+/// \endcode
+///
+template< typename ... Entries, std::size_t buffer_size >
+class any_struct< interface<Entries...>, buffer_size >
+{
+    static_assert( !detail::tag_table_v<Entries::tag()...>.duplicate, "A tag is used by more than one method or property of the interface." );
+
+    struct vtable
+    {
+        void (*destroy)( any_struct& ) noexcept;
+        void (*copy)( any_struct const&, any_struct& );
+        void (*move)( any_struct&, any_struct& ) noexcept;
+        std::tuple<typename Entries::function_type...> entries;
+    };//struct vtable
+
+    template< typename S >
+    static constexpr bool stored_in_place = sizeof(S) <= buffer_size && alignof(S) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<S>;
+
+    template< typename S >
+    static constexpr vtable vtable_of
+    {
+        []( any_struct& self ) noexcept
+        {
+            if constexpr ( stored_in_place<S> ) std::destroy_at( static_cast<S*>( self.object_ ) );
+            else delete static_cast<S*>( self.object_ );
+        },
+        []( any_struct const& from, any_struct& to )
+        {
+            if constexpr ( stored_in_place<S> ) to.object_ = ::new( static_cast<void*>( to.buffer_ ) ) S( *static_cast<S const*>( from.object_ ) );
+            else to.object_ = new S( *static_cast<S const*>( from.object_ ) );
+        },
+        []( any_struct& from, any_struct& to ) noexcept
+        {
+            if constexpr ( stored_in_place<S> )
+            {
+                to.object_ = ::new( static_cast<void*>( to.buffer_ ) ) S( std::move( *static_cast<S*>( from.object_ ) ) );
+                std::destroy_at( static_cast<S*>( from.object_ ) );
+            }
+            else
+                to.object_ = from.object_;
+        },
+        { &Entries::template thunk<S>... }
+    };
+
+    template< fixed_string tag_ >
+    static constexpr std::size_t entry_index() noexcept
+    {
+        constexpr std::size_t index = detail::tag_table_v<Entries::tag()...>.find( tag_.view(), tag_.hash() );
+        static_assert( index < sizeof...(Entries), "This field is not defined in the interface." );
+        return index;
+    }
+
+    vtable const* vtable_ = nullptr;
+    void* object_ = nullptr;
+    alignas(std::max_align_t) std::byte buffer_[buffer_size];
+
+    void reset() noexcept
+    {
+        if ( vtable_ == nullptr ) return;
+        vtable_->destroy( *this );
+        vtable_ = nullptr;
+        object_ = nullptr;
+    }
+
+public:
+    any_struct() noexcept = default;
+
+    template< Structure S >
+    requires ( !std::is_same_v<std::remove_cvref_t<S>, any_struct> )
+    any_struct( S&& s )
+    {
+        using type = std::remove_cvref_t<S>;
+        static_assert( implements_v<type, interface<Entries...>>, "The structure does not implement every method and property of the interface." );
+        static_assert( std::is_copy_constructible_v<type>, "The structure must be copyable." );
+        if constexpr ( stored_in_place<type> ) object_ = ::new( static_cast<void*>( buffer_ ) ) type( std::forward<S>(s) );
+        else object_ = new type( std::forward<S>(s) );
+        vtable_ = &vtable_of<type>;
+    }
+
+    any_struct( any_struct const& other )
+    {
+        if ( other.vtable_ == nullptr ) return;
+        other.vtable_->copy( other, *this );
+        vtable_ = other.vtable_;
+    }
+
+    any_struct( any_struct&& other ) noexcept
+    {
+        if ( other.vtable_ == nullptr ) return;
+        other.vtable_->move( other, *this );
+        vtable_ = std::exchange( other.vtable_, nullptr );
+        other.object_ = nullptr;
+    }
+
+    any_struct& operator = ( any_struct other ) noexcept
+    {
+        reset();
+        if ( other.vtable_ != nullptr )
+        {
+            other.vtable_->move( other, *this );
+            vtable_ = std::exchange( other.vtable_, nullptr );
+            other.object_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~any_struct() noexcept
+    {
+        reset();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return vtable_ != nullptr;
+    }
+
+    ///
+    /// @brief Call the method `tag`, the arguments being converted to the parameters of its signature.
+    ///
+    template< fixed_string tag_, typename ... As >
+    decltype(auto) call( As&& ... args ) const
+    {
+        return std::get<entry_index<tag_>()>( vtable_->entries )( object_, std::forward<As>(args)... );
+    }
+
+    ///
+    /// @brief Read the property `tag`.
+    ///
+    template< fixed_string tag_ >
+    decltype(auto) read() const
+    {
+        return std::get<entry_index<tag_>()>( vtable_->entries )( object_ );
+    }
+
+    template< fixed_string tag_ >
+    static constexpr bool has() noexcept
+    {
+        return detail::tag_table_v<Entries::tag()...>.find( tag_.view(), tag_.hash() ) < sizeof...(Entries);
+    }
+};//class any_struct
+
+}//namespace meta
+
+#endif//META_ANY_HPP_INCLUDED_WERTYUIOPLKJHGFDSAZXCVBNM0192837465MNBVCXZASDF
@@ -0,0 +1,294 @@
+#ifndef META_ATOMIC_HPP_INCLUDED_ZMXNCBVLAKSJDHFGQPWOEIRUTY1029384756POIUYTREW
+#define META_ATOMIC_HPP_INCLUDED_ZMXNCBVLAKSJDHFGQPWOEIRUTY1029384756POIUYTREW
+
+#include "./meta_structure.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace meta
+{
+
+namespace detail
+{
+
+///
+/// @brief Epoch-based reclamation shared by every `atomic_struct`. A reader announces the global epoch when it enters, and leaves by announcing `idle`.
+///        A version retired in epoch `e` is freed once every reader has announced an epoch after `e`, so that no reader can still hold it.
+///
+class rcu_domain
+{
+public:
+    static constexpr std::uint64_t idle = std::numeric_limits<std::uint64_t>::max();
+
+private:
+    // one per thread which ever read, reused after the thread exits
+    struct record
+    {
+        alignas(64) std::atomic<std::uint64_t> epoch_{ idle };
+        std::atomic<bool> used_{ true };
+        record* next_ = nullptr;
+        std::size_t nesting_ = 0;  // only accessed by the owner
+    };//struct record
+
+    struct owner
+    {
+        record* record_;
+        ~owner() noexcept { record_->used_.store( false, std::memory_order_release ); }
+    };//struct owner
+
+    alignas(64) std::atomic<std::uint64_t> epoch_{ 0 };
+    std::atomic<record*> records_{ nullptr };
+
+    record* acquire()
+    {
+        for ( record* r = records_.load( std::memory_order_acquire ); r != nullptr; r = r->next_ )
+            if ( bool expected = false; r->used_.compare_exchange_strong( expected, true, std::memory_order_acquire ) )
+                return r;
+        record* r = new record;
+        r->next_ = records_.load( std::memory_order_relaxed );
+        while ( !records_.compare_exchange_weak( r->next_, r, std::memory_order_release, std::memory_order_relaxed ) );
+        return r;
+    }
+
+    // the record of the calling thread, acquired by its first read
+    record& local()
+    {
+        static thread_local owner o{ acquire() };
+        return *o.record_;
+    }
+
+    rcu_domain() noexcept = default;
+
+public:
+    rcu_domain( rcu_domain const& ) = delete;
+    rcu_domain& operator = ( rcu_domain const& ) = delete;
+
+    ~rcu_domain() noexcept
+    {
+        for ( record* r = records_.load(); r != nullptr; )
+            delete std::exchange( r, r->next_ );
+    }
+
+    static rcu_domain& instance()
+    {
+        static rcu_domain domain;
+        return domain;
+    }
+
+    // enters a read-side critical section, they nest
+    void lock()
+    {
+        record& r = local();
+        if ( r.nesting_++ == 0 )
+            r.epoch_.store( epoch_.load( std::memory_order_seq_cst ), std::memory_order_seq_cst );
+    }
+
+    void unlock() noexcept
+    {
+        record& r = local();
+        if ( --r.nesting_ == 0 )
+            r.epoch_.store( idle, std::memory_order_release );
+    }
+
+    // starts a new epoch, and returns the one the versions unpublished so far are retired in
+    std::uint64_t advance() noexcept
+    {
+        return epoch_.fetch_add( 1, std::memory_order_seq_cst );
+    }
+
+    // the oldest epoch announced by a reader, or `idle`
+    std::uint64_t oldest() const noexcept
+    {
+        std::uint64_t ans = idle;
+        for ( record* r = records_.load( std::memory_order_acquire ); r != nullptr; r = r->next_ )
+            ans = std::min( ans, r->epoch_.load( std::memory_order_seq_cst ) );
+        return ans;
+    }
+};//class rcu_domain
+
+}//namespace detail
+
+template< Structure Schema >
+class atomic_struct;
+
+///
+/// @brief A meta structure shared by many readers and updated by a writer. `snapshot()` pins the current version with a wait-free read,
+///        and `publish` installs a new version copying only the updated fields: every field lives in its own allocation, shared by the versions which did not update it.
+///        A replaced version is freed once no snapshot can see it. Computed members are rejected at compile time.
+/// Example:
+/// \code{.cpp}
+/// atomic_struct config{ create_struct( make_member<"threads">( 8 ), make_member<"model">( load_model() ) ) };
+/// // a reader
+/// auto const s = config.snapshot();
+/// run( s.read<"threads">(), s.read<"model">() );
+/// // the writer, "model" is shared with the previous version
+/// config.publish( make_member<"threads">( 16 ) );
+/// \endcode
+///
+template< typename ... Ms >
+class atomic_struct< structure<detail::storage<Ms...>> >
+{
+    // a shared field would be read as its `computed` wrapper, and its cache filled by several readers at once
+    static_assert( ( !is_computed_v<typename Ms::value_type> && ... ), "atomic_struct does not hold computed members: delete them before sharing the structure." );
+
+public:
+    typedef structure<detail::storage<Ms...>> schema_type;
+
+private:
+    typedef structure<detail::storage<member<Ms::tag(), std::shared_ptr<typename Ms::value_type const>>...>> version_type;
+
+    template< fixed_string tag_ >
+    static constexpr std::size_t field_index() noexcept
+    {
+        constexpr std::size_t index = detail::index_of<tag_, Ms...>();
+        static_assert( index < sizeof...(Ms), "This field is not defined in the structure." );
+        return index;
+    }
+
+    template< fixed_string tag_ >
+    using field_type = typename detail::type_at<field_index<tag_>(), Ms...>::value_type;
+
+    std::atomic<version_type const*> current_;
+    std::mutex writer_;
+    std::vector<std::pair<std::uint64_t, version_type const*>> retired_;  // with the epoch they were retired in
+
+    template< Structure S >
+    static version_type const* make_version( S&& s )
+    {
+        return new version_type{ map_struct( std::forward<S>(s), []<Member M>( M&& m ) { return std::make_shared<typename std::remove_cvref_t<M>::value_type const>( std::forward<M>(m).value() ); } ) };
+    }
+
+    // installs `next` and frees the retired versions no reader can see, with `writer_` held
+    void install( version_type const* next )
+    {
+        version_type const* previous = current_.exchange( next, std::memory_order_seq_cst );
+        retired_.emplace_back( detail::rcu_domain::instance().advance(), previous );
+        std::uint64_t const oldest = detail::rcu_domain::instance().oldest();
+        std::erase_if( retired_, [oldest]( auto const& retired )
+        {
+            if ( retired.first >= oldest ) return false;
+            delete retired.second;
+            return true;
+        } );
+    }
+
+public:
+    ///
+    /// @brief A pinned version: its fields stay alive and unchanged as long as it exists. It must be destroyed by the thread which created it.
+    ///
+    class snapshot_type
+    {
+        version_type const* version_;
+
+    public:
+        explicit snapshot_type( atomic_struct const& source ) : version_( ( detail::rcu_domain::instance().lock(), source.current_.load( std::memory_order_seq_cst ) ) ) {}
+
+        snapshot_type( snapshot_type const& ) = delete;
+        snapshot_type& operator = ( snapshot_type const& ) = delete;
+
+        ~snapshot_type() noexcept
+        {
+            detail::rcu_domain::instance().unlock();
+        }
+
+        template< fixed_string tag_ >
+        field_type<tag_> const& read() const noexcept
+        {
+            return *version_->template read<tag_>();
+        }
+
+        template< fixed_string tag_ >
+        static constexpr bool has() noexcept
+        {
+            return detail::index_of<tag_, Ms...>() < sizeof...(Ms);
+        }
+
+        static constexpr std::size_t size() noexcept
+        {
+            return sizeof...(Ms);
+        }
+
+        operator schema_type() const
+        {
+            return map_struct( *version_, []<Member M>( M const& m ) { return *m.value(); } );
+        }
+    };//class snapshot_type
+
+    explicit atomic_struct( schema_type const& s ) : current_( make_version( s ) ) {}
+    explicit atomic_struct( schema_type&& s ) : current_( make_version( std::move( s ) ) ) {}
+
+    atomic_struct( atomic_struct const& ) = delete;
+    atomic_struct& operator = ( atomic_struct const& ) = delete;
+
+    // no snapshot may outlive the structure
+    ~atomic_struct() noexcept
+    {
+        delete current_.load();
+        for ( auto const& retired : retired_ )
+            delete retired.second;
+    }
+
+    ///
+    /// @brief Pin the current version, without waiting nor writing to memory shared with the other readers.
+    ///
+    snapshot_type snapshot() const
+    {
+        return snapshot_type{ *this };
+    }
+
+    ///
+    /// @brief A copy of the current version.
+    ///
+    schema_type load() const
+    {
+        return snapshot();
+    }
+
+    ///
+    /// @brief Publish a version with the `updates` fields replaced, the other fields being shared with the current version.
+    ///        Writers are serialized. The updated fields must exist and keep their types.
+    ///
+    template< Member ... Us >
+    void publish( Us&& ... updates )
+    {
+        static_assert( ( std::is_constructible_v<field_type<std::remove_cvref_t<Us>::tag()>, decltype(std::forward<Us>(updates).value())> && ... ),
+                       "An updated field must keep the type of the field." );
+        auto const share = []<Member U>( U&& u )
+        {
+            using value_type = field_type<std::remove_cvref_t<U>::tag()>;
+            return member<std::remove_cvref_t<U>::tag(), std::shared_ptr<value_type const>>{ std::make_shared<value_type const>( std::forward<U>(u).value() ) };
+        };
+        // the fields are built before the lock is taken
+        auto shared = create_struct( share( std::forward<Us>(updates) )... );
+        std::lock_guard lock{ writer_ };
+        std::move( shared )( [&]<Member ... SS>( SS&& ... fields )
+        {
+            install( new version_type{ update_fields( *current_.load( std::memory_order_relaxed ), std::forward<SS>(fields)... ) } );
+        } );
+    }
+
+    ///
+    /// @brief Publish a whole new version, no field is shared.
+    ///
+    void publish( schema_type const& s )
+    {
+        version_type const* next = make_version( s );
+        std::lock_guard lock{ writer_ };
+        install( next );
+    }
+};//class atomic_struct
+
+template< Structure S >
+atomic_struct( S const& ) -> atomic_struct<S>;
+
+}//namespace meta
+
+#endif//META_ATOMIC_HPP_INCLUDED_ZMXNCBVLAKSJDHFGQPWOEIRUTY1029384756POIUYTREW
@@ -0,0 +1,349 @@
+#ifndef META_CSV_HPP_INCLUDED_LKJHGFDSAPOIUYTREWQMNBVCXZ0987654321ASDFGHJKL
+#define META_CSV_HPP_INCLUDED_LKJHGFDSAPOIUYTREWQMNBVCXZ0987654321ASDFGHJKL
+
+#include "./meta_soa_vector.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace meta
+{
+
+struct csv_options
+{
+    char delimiter = ',';
+    std::size_t chunk_size = std::size_t{1} << 22;  ///< bytes read from a file at once, by each thread
+    std::size_t batch_rows = 4096;                  ///< rows added to the columns at once
+    unsigned threads = 1;                           ///< threads parsing a chunk, split at record boundaries
+};//struct csv_options
+
+struct csv_result
+{
+    std::size_t rows = 0;    ///< rows appended
+    std::size_t record = 0;  ///< the record which could not be parsed, counting from 1 with the header, or 0
+    bool ok = true;          ///< false if the file could not be read, or a field could not be converted to the type of its column
+
+    explicit operator bool() const noexcept { return ok; }
+};//struct csv_result
+
+namespace detail
+{
+
+// converts a field to the type of its column, an empty field leaves the value-initialized value
+template< typename T >
+bool csv_convert( std::string_view field, T& value )
+{
+    if ( field.empty() )
+        return true;
+    if constexpr ( std::is_same_v<T, bool> )
+    {
+        if ( field == "1" || field == "true" ) { value = true; return true; }
+        if ( field == "0" || field == "false" ) { value = false; return true; }
+        return false;
+    }
+    else if constexpr ( std::is_arithmetic_v<T> )
+    {
+        auto const [ptr, ec] = std::from_chars( field.data(), field.data() + field.size(), value );
+        return ec == std::errc{} && ptr == field.data() + field.size();
+    }
+    else if constexpr ( std::is_same_v<T, std::string> )
+    {
+        value.assign( field );
+        return true;
+    }
+    else
+    {
+        static_assert( std::is_same_v<T, std::string>, "This field type cannot be read from CSV." );
+        return false;
+    }
+}
+
+// the length of the complete records in `text`: up to the last line feed which is not in a quoted field
+inline std::size_t csv_complete( std::string_view text ) noexcept
+{
+    std::size_t ans = 0;
+    bool quoted = false;
+    for ( std::size_t index = 0; index < text.size(); ++index )
+        if ( text[index] == '"' ) quoted = !quoted;
+        else if ( text[index] == '\n' && !quoted ) ans = index + 1;
+    return ans;
+}
+
+// splits `text`, made of complete records, into `parts` slices of about the same length at record boundaries
+inline std::vector<std::size_t> csv_split( std::string_view text, std::size_t parts )
+{
+    std::vector<std::size_t> ends;
+    bool quoted = false;
+    for ( std::size_t index = 0; index < text.size() && ends.size() + 1 < parts; ++index )
+        if ( text[index] == '"' ) quoted = !quoted;
+        else if ( text[index] == '\n' && !quoted && index + 1 >= text.size() * ( ends.size() + 1 ) / parts ) ends.push_back( index + 1 );
+    ends.push_back( text.size() );
+    return ends;
+}
+
+template< typename S >
+class csv_loader;
+
+///
+/// @brief Maps the columns of a CSV header to the fields of `Schema` once, then parses records straight into the columns of a `soa_vector`.
+///
+template< typename ... Ms >
+class csv_loader< structure<storage<Ms...>> >
+{
+    typedef structure<storage<Ms...>> schema_type;
+    typedef soa_vector<schema_type> vector_type;
+    typedef bool (*converter_type)( vector_type&, std::size_t, std::string_view );
+
+    static constexpr std::size_t fields = sizeof...(Ms);
+    static constexpr std::size_t skipped = fields;
+
+    // the converter of every field, in the order of the fields
+    static constexpr std::array<converter_type, fields> converters{ { []( vector_type& v, std::size_t row, std::string_view field ) { return csv_convert( field, v.template col<Ms::tag()>()[row] ); }... } };
+
+    csv_options options_;
+    std::vector<std::size_t> columns_; // the field of every CSV column, or `skipped`
+    bool has_header_ = false;
+
+    // a quoted field ends on a delimiter or on the end of the record
+    bool field_end( std::string_view text, std::size_t pos ) const noexcept
+    {
+        return pos == text.size() || text[pos] == options_.delimiter || text[pos] == '\n' || ( text[pos] == '\r' && ( pos + 1 == text.size() || text[pos+1] == '\n' ) );
+    }
+
+    // one field starting at `pos`, unquoted in `scratch` if needed, or nothing if a quoted field is malformed; `pos` is left on the delimiter or the end of the record
+    std::optional<std::string_view> next_field( std::string_view text, std::size_t& pos, std::string& scratch ) const
+    {
+        if ( pos < text.size() && text[pos] == '"' )
+        {
+            std::size_t const first = ++pos;
+            std::size_t close = text.find( '"', first );
+            if ( close == std::string_view::npos )
+                return std::nullopt;
+            if ( close + 1 == text.size() || text[close+1] != '"' )
+            {
+                pos = close + 1;
+                return field_end( text, pos ) ? std::optional{ text.substr( first, close - first ) } : std::nullopt;
+            }
+            // an escaped quote, the field is copied without the doubled quotes
+            scratch.assign( text.substr( first, close + 1 - first ) );
+            for ( pos = close + 2;; )
+            {
+                close = text.find( '"', pos );
+                if ( close == std::string_view::npos )
+                    return std::nullopt;
+                bool const escaped = close + 1 < text.size() && text[close+1] == '"';
+                scratch.append( text.substr( pos, close + escaped - pos ) );
+                pos = close + 1 + escaped;
+                if ( !escaped )
+                    return field_end( text, pos ) ? std::optional{ std::string_view{ scratch } } : std::nullopt;
+            }
+        }
+        std::size_t const first = pos;
+        while ( pos < text.size() && text[pos] != options_.delimiter && text[pos] != '\n' )
+            ++pos;
+        std::size_t const last = pos > first && text[pos-1] == '\r' && ( pos == text.size() || text[pos] == '\n' ) ? pos - 1 : pos;
+        return text.substr( first, last - first );
+    }
+
+    // skips the end of a record: "\r\n" or "\n", if `pos` is not on a delimiter
+    bool next_column( std::string_view text, std::size_t& pos ) const noexcept
+    {
+        if ( pos < text.size() && text[pos] == options_.delimiter )
+        {
+            ++pos;
+            return true;
+        }
+        while ( pos < text.size() && text[pos] != '\n' )
+            ++pos;
+        pos += pos < text.size();
+        return false;
+    }
+
+    // the header, mapping every column to a field by one lookup in the perfect-hash table of the tags
+    std::size_t header( std::string_view text )
+    {
+        std::size_t pos = 0;
+        std::string scratch;
+        do
+        {
+            std::string_view const name = next_field( text, pos, scratch ).value_or( std::string_view{} );
+            std::size_t const index = index_of_name<storage<Ms...>>( name );
+            columns_.push_back( index < fields ? index : skipped );
+        } while ( next_column( text, pos ) );
+        has_header_ = true;
+        return pos;
+    }
+
+public:
+    explicit csv_loader( csv_options const& options ) noexcept : options_{ options } {}
+
+    csv_options const& options() const noexcept { return options_; }
+
+    ///
+    /// @brief Parse the complete records in `text` into `out`, in batches of rows. `records` counts the records parsed, blank ones included.
+    ///        Returns false on the first field which is malformed or cannot be converted, `records` being the number of the records before it.
+    ///
+    bool parse( std::string_view text, vector_type& out, std::size_t& records ) const
+    {
+        std::size_t rows = out.size();
+        std::size_t pos = 0;
+        std::string scratch;
+        bool ok = true;
+        while ( pos < text.size() && ok )
+        {
+            if ( text[pos] == '\n' || ( text[pos] == '\r' && pos + 1 < text.size() && text[pos+1] == '\n' ) ) // a blank line
+            {
+                pos += text[pos] == '\r' ? 2 : 1;
+                ++records;
+                continue;
+            }
+            if ( rows == out.size() )
+                out.resize( rows + std::max( std::size_t{1}, options_.batch_rows ) );
+            std::size_t column = 0;
+            do
+            {
+                std::optional<std::string_view> const field = next_field( text, pos, scratch );
+                if ( !field || ( column < columns_.size() && columns_[column] != skipped && !converters[columns_[column]]( out, rows, *field ) ) )
+                    ok = false;
+                ++column;
+            } while ( ok && next_column( text, pos ) );
+            if ( ok )
+            {
+                ++rows;
+                ++records;
+            }
+        }
+        out.resize( rows );
+        return ok;
+    }
+
+    ///
+    /// @brief Parse a chunk made of complete records, the header first if it has not been seen, with `options().threads` threads.
+    ///
+    bool feed( std::string_view text, vector_type& out, csv_result& result )
+    {
+        if ( !has_header_ && !text.empty() )
+        {
+            text.remove_prefix( header( text ) );
+            ++result.record;
+        }
+        std::size_t const before = out.size();
+        bool ok = true;
+        if ( options_.threads <= 1 || text.size() < options_.threads * 1024 )
+            ok = parse( text, out, result.record );
+        else
+        {
+            std::vector<std::size_t> const ends = csv_split( text, options_.threads );
+            std::vector<vector_type> parts( ends.size() );
+            std::vector<std::size_t> records( ends.size(), 0 );
+            std::vector<char> parsed( ends.size(), 0 );
+            {
+                std::vector<std::jthread> workers;
+                for ( std::size_t part = 1; part < ends.size(); ++part )
+                    workers.emplace_back( [&, part]() { parsed[part] = parse( text.substr( ends[part-1], ends[part] - ends[part-1] ), parts[part], records[part] ); } );
+                parsed[0] = parse( text.substr( 0, ends[0] ), parts[0], records[0] );
+            }
+            // the parts are appended in order, up to the first failure
+            for ( std::size_t part = 0; part < ends.size() && ok; ++part )
+            {
+                out.append( std::move( parts[part] ) );
+                result.record += records[part];
+                ok = parsed[part];
+            }
+        }
+        result.rows += out.size() - before;
+        if ( !ok )
+            ++result.record;
+        return ok;
+    }
+};//class csv_loader
+
+}//namespace detail
+
+///
+/// @brief PARSE CSV text into the columns of `out`. The header row maps the columns to the tags of the fields once:
+///        columns without a field are skipped, and fields without a column are value-initialized, as are empty fields.
+///        Fields are converted in place by `std::from_chars`, quoted fields may hold delimiters, line feeds and doubled quotes.
+/// Example:
+/// \code{.cpp}
+/// soa_vector<decltype(prototype)> v;
+/// csv_result const result = parse_csv( "id,x\n1,0.5\n2,1.5\n", v );
+/// \endcode
+///
+template< Structure S >
+csv_result parse_csv( std::string_view text, soa_vector<S>& out, csv_options const& options = {} )
+{
+    detail::csv_loader<S> loader{ options };
+    csv_result result;
+    result.ok = loader.feed( text, out, result );
+    if ( result.ok )
+        result.record = 0;
+    return result;
+}
+
+///
+/// @brief LOAD a CSV file into the columns of `out`, as `parse_csv` would. The file is read in chunks of `options.chunk_size` bytes per thread,
+///        each one split at record boundaries and parsed by `options.threads` threads; a record longer than a chunk grows the buffer.
+/// Example:
+/// \code{.cpp}
+/// soa_vector<decltype(prototype)> v;
+/// if ( csv_result const result = load_csv( "nightly.csv", v, csv_options{ .threads = 8 } ); !result )
+///     std::cerr << "failed at record " << result.record << std::endl;
+/// \endcode
+///
+template< Structure S >
+csv_result load_csv( std::filesystem::path const& path, soa_vector<S>& out, csv_options const& options = {} )
+{
+    csv_result result;
+    std::unique_ptr<std::FILE, int (*)( std::FILE* )> const file{ std::fopen( path.c_str(), "rb" ), &std::fclose };
+    if ( !file )
+    {
+        result.ok = false;
+        return result;
+    }
+
+    detail::csv_loader<S> loader{ options };
+    std::vector<char> buffer( std::max( std::size_t{1}, options.chunk_size ) * std::max( 1U, options.threads ) );
+    std::size_t filled = 0;
+    for (;;)
+    {
+        filled += std::fread( buffer.data() + filled, 1, buffer.size() - filled, file.get() );
+        bool const last = filled < buffer.size();
+        if ( last && std::ferror( file.get() ) )
+        {
+            result.ok = false;
+            return result;
+        }
+        std::string_view const text{ buffer.data(), filled };
+        std::size_t const complete = last ? filled : detail::csv_complete( text );
+        if ( complete == 0 && !last ) // a record longer than the buffer
+        {
+            buffer.resize( buffer.size() * 2 );
+            continue;
+        }
+        if ( !loader.feed( text.substr( 0, complete ), out, result ) )
+        {
+            result.ok = false;
+            return result;
+        }
+        if ( last )
+            break;
+        // the incomplete record is moved to the front of the buffer
+        std::copy( buffer.begin() + complete, buffer.begin() + filled, buffer.begin() );
+        filled -= complete;
+    }
+    result.record = 0;
+    return result;
+}
+
+}//namespace meta
+
+#endif//META_CSV_HPP_INCLUDED_LKJHGFDSAPOIUYTREWQMNBVCXZ0987654321ASDFGHJKL
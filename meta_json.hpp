@@ -0,0 +1,520 @@
+#ifndef META_JSON_HPP_INCLUDED_ZMXNCBVLAKSJDHFGQPWOEIRUTY5647382910POQWIEURYT
+#define META_JSON_HPP_INCLUDED_ZMXNCBVLAKSJDHFGQPWOEIRUTY5647382910POQWIEURYT
+
+#include "./meta_structure.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace meta
+{
+
+namespace detail
+{
+
+template< typename T >
+struct is_vector : std::false_type {};
+
+template< typename T, typename A >
+struct is_vector< std::vector<T, A> > : std::true_type {};
+
+///
+/// @brief Single-pass reader over a JSON text: the values are parsed straight into the fields, no document is built.
+///
+struct json_reader
+{
+    char const* it;
+    char const* end;
+    std::string scratch; // unescaped key, only used when a key holds an escape sequence
+
+    void skip_space() noexcept
+    {
+        while ( it != end && ( *it == ' ' || *it == '\n' || *it == '\r' || *it == '\t' ) )
+            ++it;
+    }
+
+    // skips the white spaces, then consumes `ch` if it is the next character
+    bool consume( char ch ) noexcept
+    {
+        skip_space();
+        if ( it == end || *it != ch )
+            return false;
+        ++it;
+        return true;
+    }
+
+    bool literal( std::string_view word ) noexcept
+    {
+        if ( static_cast<std::size_t>( end - it ) < word.size() || std::string_view{ it, word.size() } != word )
+            return false;
+        it += word.size();
+        return true;
+    }
+
+    static int hex_digit( char ch ) noexcept
+    {
+        if ( ch >= '0' && ch <= '9' ) return ch - '0';
+        if ( ch >= 'a' && ch <= 'f' ) return ch - 'a' + 10;
+        if ( ch >= 'A' && ch <= 'F' ) return ch - 'A' + 10;
+        return -1;
+    }
+
+    bool hex4( std::uint32_t& code ) noexcept
+    {
+        if ( end - it < 4 )
+            return false;
+        code = 0;
+        for ( int index = 0; index < 4; ++index )
+        {
+            int const digit = hex_digit( *it++ );
+            if ( digit < 0 )
+                return false;
+            code = code * 16 + static_cast<std::uint32_t>( digit );
+        }
+        return true;
+    }
+
+    static void append_utf8( std::string& out, std::uint32_t code )
+    {
+        if ( code < 0x80 )
+            out += static_cast<char>( code );
+        else if ( code < 0x800 )
+        {
+            out += static_cast<char>( 0xc0 | ( code >> 6 ) );
+            out += static_cast<char>( 0x80 | ( code & 0x3f ) );
+        }
+        else if ( code < 0x10000 )
+        {
+            out += static_cast<char>( 0xe0 | ( code >> 12 ) );
+            out += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3f ) );
+            out += static_cast<char>( 0x80 | ( code & 0x3f ) );
+        }
+        else
+        {
+            out += static_cast<char>( 0xf0 | ( code >> 18 ) );
+            out += static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3f ) );
+            out += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3f ) );
+            out += static_cast<char>( 0x80 | ( code & 0x3f ) );
+        }
+    }
+
+    // the rest of an escape sequence, after the backslash
+    bool unescape( std::string& out )
+    {
+        if ( it == end )
+            return false;
+        switch ( *it++ )
+        {
+            case '"':  out += '"';  return true;
+            case '\\': out += '\\'; return true;
+            case '/':  out += '/';  return true;
+            case 'b':  out += '\b'; return true;
+            case 'f':  out += '\f'; return true;
+            case 'n':  out += '\n'; return true;
+            case 'r':  out += '\r'; return true;
+            case 't':  out += '\t'; return true;
+            case 'u':
+            {
+                std::uint32_t code;
+                if ( !hex4( code ) )
+                    return false;
+                if ( code >= 0xd800 && code < 0xdc00 ) // a high surrogate is followed by a low one
+                {
+                    std::uint32_t low;
+                    if ( !literal( "\\u" ) || !hex4( low ) || low < 0xdc00 || low >= 0xe000 )
+                        return false;
+                    code = 0x10000 + ( ( code - 0xd800 ) << 10 ) + ( low - 0xdc00 );
+                }
+                else if ( code >= 0xdc00 && code < 0xe000 )
+                    return false;
+                append_utf8( out, code );
+                return true;
+            }
+            default: return false;
+        }
+    }
+
+    // a string is appended to `out`, the runs without escape sequences are copied at once
+    bool string( std::string& out )
+    {
+        if ( !consume( '"' ) )
+            return false;
+        for (;;)
+        {
+            char const* first = it;
+            while ( it != end && *it != '"' && *it != '\\' && static_cast<unsigned char>( *it ) >= 0x20 )
+                ++it;
+            out.append( first, it );
+            if ( it == end || static_cast<unsigned char>( *it ) < 0x20 )
+                return false;
+            if ( *it++ == '"' )
+                return true;
+            if ( !unescape( out ) )
+                return false;
+        }
+    }
+
+    // a key is viewed in place, unless it holds an escape sequence
+    bool key( std::string_view& name )
+    {
+        if ( !consume( '"' ) )
+            return false;
+        char const* first = it;
+        while ( it != end && *it != '"' && *it != '\\' && static_cast<unsigned char>( *it ) >= 0x20 )
+            ++it;
+        if ( it != end && *it == '"' )
+        {
+            name = std::string_view{ first, static_cast<std::size_t>( it++ - first ) };
+            return consume( ':' );
+        }
+        it = first - 1;
+        scratch.clear();
+        if ( !string( scratch ) )
+            return false;
+        name = scratch;
+        return consume( ':' );
+    }
+
+    // the end of the number starting at `first` as JSON writes it, -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?, or `first` if there is none
+    char const* number_end( char const* first ) const noexcept
+    {
+        auto const digits = [this]( char const* p ) noexcept { while ( p != end && *p >= '0' && *p <= '9' ) ++p; return p; };
+        char const* p = first;
+        if ( p != end && *p == '-' )
+            ++p;
+        if ( p == end || *p < '0' || *p > '9' )
+            return first;
+        p = *p == '0' ? p + 1 : digits( p );
+        if ( p != end && *p == '.' )
+        {
+            char const* const fraction = digits( p + 1 );
+            if ( fraction == p + 1 )
+                return first;
+            p = fraction;
+        }
+        if ( p != end && ( *p == 'e' || *p == 'E' ) )
+        {
+            char const* const sign = p + 1 + ( p + 1 != end && ( p[1] == '+' || p[1] == '-' ) );
+            char const* const exponent = digits( sign );
+            if ( exponent == sign )
+                return first;
+            p = exponent;
+        }
+        return p;
+    }
+
+    // a number must be written as JSON writes it, and be parsed by `std::from_chars` to its end: no leading '+' nor zeros, no "inf" nor "nan", no ".5" nor "1."
+    template< typename T >
+    bool number( T& value ) noexcept
+    {
+        skip_space();
+        char const* const last = number_end( it );
+        if ( last == it )
+            return false;
+        auto const [ptr, ec] = std::from_chars( it, last, value );
+        if ( ec != std::errc{} || ptr != last )
+            return false;
+        it = ptr;
+        return true;
+    }
+
+    // skips a string, its escape sequences checked but not unescaped
+    bool skip_string() noexcept
+    {
+        if ( !consume( '"' ) )
+            return false;
+        while ( it != end )
+        {
+            char const ch = *it++;
+            if ( ch == '"' )
+                return true;
+            if ( static_cast<unsigned char>( ch ) < 0x20 )
+                return false;
+            if ( ch == '\\' )
+            {
+                std::uint32_t code = 0;
+                if ( it == end )
+                    return false;
+                if ( *it == 'u' ? ( ++it, !hex4( code ) ) : std::string_view{ "\"\\/bfnrt" }.find( *it++ ) == std::string_view::npos )
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    // nested objects and arrays skipped deeper than this are rejected, rather than overflowing the stack
+    static constexpr std::size_t max_depth = 512;
+
+    // skips a value of a key not in the structure, nested objects and arrays included, and rejects it if it is not valid JSON
+    bool skip( std::size_t depth = 0 ) noexcept
+    {
+        skip_space();
+        if ( it == end )
+            return false;
+        switch ( *it )
+        {
+            case '"': return skip_string();
+            case 't': return literal( "true" );
+            case 'f': return literal( "false" );
+            case 'n': return literal( "null" );
+            case '{':
+            case '[':
+            {
+                char const close = *it++ == '{' ? '}' : ']';
+                if ( depth == max_depth )
+                    return false;
+                if ( consume( close ) )
+                    return true;
+                do
+                {
+                    if ( close == '}' && ( !skip_string() || !consume( ':' ) ) )
+                        return false;
+                    if ( !skip( depth + 1 ) )
+                        return false;
+                } while ( consume( ',' ) );
+                return consume( close );
+            }
+            default:
+            {
+                char const* const last = number_end( it );
+                if ( last == it )
+                    return false;
+                it = last;
+                return true;
+            }
+        }
+    }
+};//struct json_reader
+
+template< typename T >
+bool read_json( json_reader& reader, T& value );
+
+template< Structure S >
+bool read_json_object( json_reader& reader, S& structure )
+{
+    using storage_type = decltype(structure.s_);
+    using function_type = bool (*)( json_reader&, storage_type& );
+    // the parser of every field, indexed as the perfect-hash table of the tags
+    static constexpr auto jump = []<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+    {
+        return std::array<function_type, sizeof...(Is)>{ { []( json_reader& r, storage_type& st ) { return read_json( r, get<Is>( st ).value_ ); }... } };
+    }( std::make_index_sequence<S::size()>{} );
+
+    if ( !reader.consume( '{' ) )
+        return false;
+    if ( reader.consume( '}' ) )
+        return true;
+    do
+    {
+        std::string_view name;
+        if ( !reader.key( name ) )
+            return false;
+        std::size_t const index = index_of_name<storage_type>( name );
+        if ( !( index == S::size() ? reader.skip() : jump[index]( reader, structure.s_ ) ) )
+            return false;
+    } while ( reader.consume( ',' ) );
+    return reader.consume( '}' );
+}
+
+template< typename T >
+bool read_json( json_reader& reader, T& value )
+{
+    if constexpr ( is_structure_v<T> )
+        return read_json_object( reader, value );
+    else if constexpr ( std::is_same_v<T, bool> )
+    {
+        reader.skip_space();
+        if ( reader.literal( "true" ) ) { value = true; return true; }
+        if ( reader.literal( "false" ) ) { value = false; return true; }
+        return false;
+    }
+    else if constexpr ( std::is_arithmetic_v<T> )
+        return reader.number( value );
+    else if constexpr ( std::is_same_v<T, std::string> )
+    {
+        value.clear();
+        return reader.string( value );
+    }
+    else if constexpr ( is_vector<T>::value )
+    {
+        value.clear();
+        if ( !reader.consume( '[' ) )
+            return false;
+        if ( reader.consume( ']' ) )
+            return true;
+        do
+        {
+            if ( !read_json( reader, value.emplace_back() ) )
+                return false;
+        } while ( reader.consume( ',' ) );
+        return reader.consume( ']' );
+    }
+    else
+    {
+        static_assert( is_structure_v<T>, "This field type cannot be read from JSON." );
+        return false;
+    }
+}
+
+inline void write_json_string( std::string& out, std::string_view str )
+{
+    constexpr char hex[] = "0123456789abcdef";
+    out += '"';
+    while ( !str.empty() )
+    {
+        // the runs without characters to escape are copied at once
+        std::size_t run = 0;
+        while ( run < str.size() && str[run] != '"' && str[run] != '\\' && static_cast<unsigned char>( str[run] ) >= 0x20 )
+            ++run;
+        out.append( str.data(), run );
+        if ( run == str.size() )
+            break;
+        char const ch = str[run];
+        switch ( ch )
+        {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += hex[ static_cast<unsigned char>( ch ) >> 4 ];
+                out += hex[ static_cast<unsigned char>( ch ) & 0xf ];
+        }
+        str.remove_prefix( run + 1 );
+    }
+    out += '"';
+}
+
+template< typename T >
+void write_json( std::string& out, T const& value );
+
+template< Structure S >
+void write_json_object( std::string& out, S const& structure )
+{
+    out += '{';
+    structure( [&]<Member ... MS>( MS const& ... members )
+    {
+        char separator = '\0';
+        ( ( separator ? void( out += separator ) : void( separator = ',' ),
+            write_json_string( out, tag_of<MS::tag()>::value.view() ),
+            out += ':',
+            write_json( out, members.value() ) ), ... );
+    } );
+    out += '}';
+}
+
+template< typename T >
+void write_json( std::string& out, T const& value )
+{
+    if constexpr ( is_structure_v<T> )
+        write_json_object( out, value );
+    else if constexpr ( std::is_same_v<T, bool> )
+        out += value ? "true" : "false";
+    else if constexpr ( std::is_arithmetic_v<T> )
+    {
+        if constexpr ( std::is_floating_point_v<T> )
+            if ( !std::isfinite( value ) ) // JSON has no infinity nor NaN
+            {
+                out += "null";
+                return;
+            }
+        char digits[32];
+        auto const [ptr, ec] = std::to_chars( digits, digits + sizeof(digits), value );
+        out.append( digits, ptr );
+    }
+    else if constexpr ( std::is_same_v<T, std::string> )
+        write_json_string( out, value );
+    else if constexpr ( is_vector<T>::value )
+    {
+        out += '[';
+        for ( std::size_t index = 0; index < value.size(); ++index )
+        {
+            if ( index > 0 )
+                out += ',';
+            write_json( out, value[index] );
+        }
+        out += ']';
+    }
+    else
+        static_assert( is_structure_v<T>, "This field type cannot be written to JSON." );
+}
+
+}//namespace detail
+
+///
+/// @brief WRITE a meta structure as a JSON object, appended to `out`. Returns the number of characters appended.
+///        Numbers are written by `std::to_chars`, in the shortest form that reads back to the same value.
+/// Example:
+/// \code{.cpp}
+/// auto const s = create_struct( make_member<"id">( 1 ), make_member<"name">( std::string{"meta"} ) );
+/// std::string buffer;
+/// to_json( s, buffer ); // <-- {"id":1,"name":"meta"}
+/// \endcode
+///
+template< Structure S >
+std::size_t to_json( S const& structure, std::string& out )
+{
+    std::size_t const before = out.size();
+    detail::write_json_object( out, structure );
+    return out.size() - before;
+}
+
+template< Structure S >
+std::string to_json( S const& structure )
+{
+    std::string out;
+    to_json( structure, out );
+    return out;
+}
+
+///
+/// @brief READ a JSON object into the fields of `structure`, in a single pass: the keys are looked up in the perfect-hash table of the tags,
+///        and numbers are parsed by `std::from_chars`. The fields missing in `json` are left untouched, and the keys not in the structure are skipped.
+///        Returns false if `json` is not a JSON object, or a value does not fit the type of its field. The fields read before the error keep their new values.
+/// Example:
+/// \code{.cpp}
+/// auto s = create_struct( make_member<"id">( 0 ), make_member<"name">( std::string{} ) );
+/// bool const ok = from_json( R"({"name": "meta", "id": 1})", s );
+/// \endcode
+///
+template< Structure S >
+bool from_json( std::string_view json, S& structure )
+{
+    detail::json_reader reader{ json.data(), json.data() + json.size(), {} };
+    if ( !detail::read_json_object( reader, structure ) )
+        return false;
+    reader.skip_space();
+    return reader.it == reader.end;
+}
+
+///
+/// @brief READ a JSON object into a meta structure of type `Schema`, the fields missing in `json` are value-initialized.
+///        Returns `std::nullopt` if `json` is not a JSON object, or a value does not fit the type of its field.
+/// Example:
+/// \code{.cpp}
+/// using record = decltype( create_struct( make_member<"id">( 0 ), make_member<"name">( std::string{} ) ) );
+/// std::optional<record> const r = from_json<record>( R"({"name": "meta", "id": 1})" );
+/// \endcode
+///
+template< Structure Schema >
+std::optional<Schema> from_json( std::string_view json )
+{
+    std::optional<Schema> ans{ Schema{} };
+    if ( !from_json( json, *ans ) )
+        return std::nullopt;
+    return ans;
+}
+
+}//namespace meta
+
+#endif//META_JSON_HPP_INCLUDED_ZMXNCBVLAKSJDHFGQPWOEIRUTY5647382910POQWIEURYT
@@ -0,0 +1,277 @@
+#ifndef META_PARALLEL_HPP_INCLUDED_QPWOEIRUTYALSKDJFHGZMXNCBV5647382910QAZWSX
+#define META_PARALLEL_HPP_INCLUDED_QPWOEIRUTYALSKDJFHGZMXNCBV5647382910QAZWSX
+
+#include "./meta_structure.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace meta
+{
+
+///
+/// @brief A work-stealing thread pool: every worker owns a queue, takes its own tasks from the back and steals the others' from the front.
+///        A task submitted from a worker goes to the queue of that worker, the others are dealt round-robin.
+/// Example:
+/// \code{.cpp}
+/// thread_pool pool{ 8 };
+/// pool.execute( []() { std::cout << "hello" << std::endl; } );
+/// \endcode
+///
+class thread_pool
+{
+    struct worker_queue
+    {
+        std::mutex mutex_;
+        std::deque<std::function<void()>> tasks_;
+    };//struct worker_queue
+
+    std::deque<worker_queue> queues_;  // a deque, as the queues can not be moved
+    std::atomic<std::size_t> pending_{ 0 };
+    std::atomic<std::size_t> next_{ 0 };
+    std::mutex sleep_mutex_;
+    std::condition_variable_any wake_;
+    std::vector<std::jthread> workers_;  // the last member, so the workers are joined before the queues are destroyed
+
+    struct identity
+    {
+        thread_pool const* pool_ = nullptr;
+        std::size_t index_ = 0;
+    };//struct identity
+
+    static identity& this_thread_identity() noexcept
+    {
+        static thread_local identity id;
+        return id;
+    }
+
+    // the index of the calling thread in the pool, or the number of workers if it is not one of them
+    std::size_t current() const noexcept
+    {
+        identity const& id = this_thread_identity();
+        return id.pool_ == this ? id.index_ : queues_.size();
+    }
+
+    std::optional<std::function<void()>> take( std::size_t home ) noexcept
+    {
+        std::size_t const size = queues_.size();
+        for ( std::size_t offset = 0; offset != size; ++offset )
+        {
+            std::size_t const index = ( home + offset ) % size;
+            worker_queue& queue = queues_[index];
+            std::lock_guard lock{ queue.mutex_ };
+            if ( queue.tasks_.empty() ) continue;
+            std::function<void()> task;
+            if ( index == home ) { task = std::move( queue.tasks_.back() ); queue.tasks_.pop_back(); }
+            else { task = std::move( queue.tasks_.front() ); queue.tasks_.pop_front(); }
+            pending_.fetch_sub( 1, std::memory_order_relaxed );
+            return task;
+        }
+        return std::nullopt;
+    }
+
+    void work( std::stop_token stop, std::size_t index )
+    {
+        this_thread_identity() = identity{ this, index };
+        while ( !stop.stop_requested() )
+        {
+            if ( auto task = take( index ); task )
+            {
+                (*task)();
+                continue;
+            }
+            std::unique_lock lock{ sleep_mutex_ };
+            wake_.wait( lock, stop, [this]() { return pending_.load( std::memory_order_relaxed ) != 0; } );
+        }
+    }
+
+public:
+    explicit thread_pool( unsigned threads = std::max( 1U, std::thread::hardware_concurrency() ) ) : queues_( threads )
+    {
+        workers_.reserve( threads );
+        for ( unsigned index = 0; index != threads; ++index )
+            workers_.emplace_back( [this, index]( std::stop_token stop ) { work( stop, index ); } );
+    }
+
+    thread_pool( thread_pool const& ) = delete;
+    thread_pool& operator = ( thread_pool const& ) = delete;
+
+    ~thread_pool() noexcept
+    {
+        for ( auto& worker : workers_ )
+            worker.request_stop();
+        wake_.notify_all();
+    }
+
+    std::size_t size() const noexcept { return workers_.size(); }
+
+    ///
+    /// @brief Queue `task` to run on one of the workers.
+    ///
+    void execute( std::function<void()> task )
+    {
+        std::size_t index = current();
+        if ( index == queues_.size() )
+            index = next_.fetch_add( 1, std::memory_order_relaxed ) % queues_.size();
+        {
+            std::lock_guard lock{ queues_[index].mutex_ };
+            queues_[index].tasks_.push_back( std::move( task ) );
+        }
+        {
+            std::lock_guard lock{ sleep_mutex_ };
+            pending_.fetch_add( 1, std::memory_order_relaxed );
+        }
+        wake_.notify_one();
+    }
+
+    ///
+    /// @brief Run one queued task on the calling thread, so that a thread waiting for its tasks helps instead of blocking a worker.
+    ///        Returns false if there was no task.
+    ///
+    bool try_run_one()
+    {
+        std::size_t index = current();
+        auto task = take( index == queues_.size() ? 0 : index );
+        if ( !task ) return false;
+        (*task)();
+        return true;
+    }
+};//class thread_pool
+
+///
+/// @brief The pool used by `parallel_map_struct` when no executor is given, with one worker per hardware thread, started on first use.
+///
+inline thread_pool& default_thread_pool()
+{
+    static thread_pool pool;
+    return pool;
+}
+
+///
+/// @brief An executor runs a `std::function<void()>` now or later, on any thread.
+///
+template< typename E >
+concept Executor = requires( E& executor, std::function<void()> task )
+{
+    executor.execute( std::move( task ) );
+};
+
+///
+/// @brief The estimated cost of mapping a value, in bytes. Fields cheaper than `parallel_options::min_cost` are mapped inline on the calling thread.
+///        Specialize it for a payload whose size does not tell its cost.
+///
+template< typename T >
+struct parallel_cost
+{
+    constexpr std::size_t operator()( T const& value ) const noexcept
+    {
+        if constexpr ( std::ranges::sized_range<T const> )
+            return sizeof(T) + std::ranges::size( value ) * sizeof(std::ranges::range_value_t<T const>);
+        else
+            return sizeof(T);
+    }
+};//struct parallel_cost
+
+struct parallel_options
+{
+    std::size_t min_cost = 4096;  ///< fields with a smaller `parallel_cost` are mapped on the calling thread
+};//struct parallel_options
+
+namespace detail
+{
+
+template< Member M, typename F >
+using mapped_member = member<std::remove_cvref_t<M>::tag(), std::decay_t<std::invoke_result_t<F&, M&&>>>;
+
+}//namespace detail
+
+///
+/// @brief MAP a function to each field in the meta structure as `map_struct` would, the fields being mapped concurrently on `executor`.
+///        Each field costing at least `options.min_cost` is a separate task, the cheaper ones are mapped inline by the calling thread.
+///        `function` must be safe to call from several threads at once. It returns when all the fields are mapped.
+///        If `function` or `executor` throws, the first exception is rethrown once every submitted task has finished.
+/// EXAMPLE:
+/// \code{.cpp}
+/// auto const s = create_struct( make_member<"left">( std::vector<double>( 1 << 20 ) ), make_member<"right">( std::vector<double>( 1 << 20 ) ) );
+/// auto const t = parallel_map_struct( s, []<Member M>( M const& member ) { return compress( member.value() ); } );
+/// \endcode
+///
+template< Structure S, typename F, Executor E >
+auto parallel_map_struct( S&& structure, F&& function, E& executor, parallel_options options = {} )
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members )
+    {
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+        {
+            typedef structure_type<detail::mapped_member<MS, F>...> result_type;
+            std::tuple<std::optional<detail::mapped_member<MS, F>>...> results;
+            std::array<bool, sizeof...(MS)> const deferred{ { ( parallel_cost<typename std::remove_cvref_t<MS>::value_type>{}( members.value() ) >= options.min_cost )... } };
+            std::ptrdiff_t const tasks = std::count( deferred.begin(), deferred.end(), true );
+            std::ptrdiff_t submitted = 0;
+            std::latch done{ tasks };
+
+            // the first exception thrown by `function` or by `executor`, rethrown once no task can still write to this frame
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            auto const fail = [&]( std::exception_ptr e ) noexcept
+            {
+                std::lock_guard lock{ error_mutex };
+                if ( !error ) error = std::move( e );
+            };
+
+            auto const submit = [&]<std::size_t I, Member M>( M&& m )
+            {
+                executor.execute( [&, pointer = std::addressof( m )]() noexcept
+                {
+                    try { std::get<I>( results ).emplace( function( std::forward<M>( *pointer ) ) ); }
+                    catch ( ... ) { fail( std::current_exception() ); }
+                    done.count_down();
+                } );
+                ++submitted;
+            };
+            try
+            {
+                ( ( deferred[Is] ? submit.template operator()<Is>( std::forward<MS>(members) ) : void() ), ... );
+                ( ( deferred[Is] ? void() : void( std::get<Is>( results ).emplace( function( std::forward<MS>(members) ) ) ) ), ... );
+            }
+            catch ( ... )
+            {
+                fail( std::current_exception() );
+                done.count_down( tasks - submitted );  // the tasks never submitted
+            }
+
+            // the calling thread runs queued tasks while there are some, so that a worker waiting for its own tasks does not block the pool,
+            // then sleeps until the tasks running on other threads are done
+            if constexpr ( requires { executor.try_run_one(); } )
+                while ( !done.try_wait() && executor.try_run_one() );
+            done.wait();
+
+            if ( error ) std::rethrow_exception( error );
+            return result_type{ { std::move( *std::get<Is>( results ) )... } };
+        }( std::index_sequence_for<MS...>{} );
+    } );
+}
+
+template< Structure S, typename F >
+auto parallel_map_struct( S&& structure, F&& function, parallel_options options = {} )
+{
+    return parallel_map_struct( std::forward<S>(structure), std::forward<F>(function), default_thread_pool(), options );
+}
+
+}//namespace meta
+
+#endif//META_PARALLEL_HPP_INCLUDED_QPWOEIRUTYALSKDJFHGZMXNCBV5647382910QAZWSX
@@ -0,0 +1,371 @@
+#ifndef META_PATCH_HPP_INCLUDED_LKJHPOIUMNBVQWERASDFZXCV1122334455667788990AQ
+#define META_PATCH_HPP_INCLUDED_LKJHPOIUMNBVQWERASDFZXCV1122334455667788990AQ
+
+#include "./meta_serialize.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace meta
+{
+
+template< Structure Schema >
+struct struct_patch;
+
+///
+/// @brief The fields changed between two versions of a meta structure, with their new values. Computed fields are never recorded.
+///        `fields_` holds one `std::optional` per field of the schema, set if the field changed.
+/// Example:
+/// \code{.cpp}
+/// struct_patch<decltype(s)> patch = diff_struct( old_version, new_version );
+/// if ( patch.changed<"price">() ) ...
+/// \endcode
+///
+template< typename ... Ms >
+struct struct_patch< structure<detail::storage<Ms...>> >
+{
+    typedef structure<detail::storage<Ms...>> schema_type;
+
+    structure<detail::storage<member<Ms::tag(), std::optional<typename Ms::value_type>>...>> fields_{};
+
+    template< fixed_string tag_ >
+    bool changed() const noexcept
+    {
+        return fields_.template read<tag_>().has_value();
+    }
+
+    ///
+    /// @brief The new value of the field `tag`, empty if it did not change.
+    ///
+    template< fixed_string tag_ >
+    auto const& read() const noexcept
+    {
+        return fields_.template read<tag_>();
+    }
+
+    ///
+    /// @brief Record a new value of the field `tag`.
+    ///
+    template< fixed_string tag_, typename T >
+    struct_patch& set( T&& value )
+    {
+        fields_.template ref<tag_>().emplace( std::forward<T>(value) );
+        return *this;
+    }
+
+    ///
+    /// @brief Assign the changed fields to `s` in place, the other fields are not touched.
+    ///        The computed fields of `s` depending on a changed field are computed again on their next read.
+    ///        An exception thrown by an assignment propagates, the fields assigned before it keep their new values.
+    ///
+    void apply_to( schema_type& s ) const&
+    {
+        for_each_field( fields_, [&]<Member M>( M const& field )
+        {
+            if constexpr ( !is_computed_v<typename M::value_type::value_type> )
+                if ( field.value() ) s.template ref<M::tag()>() = *field.value();
+        } );
+    }
+
+    void apply_to( schema_type& s ) &&
+    {
+        for_each_field( std::move( fields_ ), [&]<Member M>( M&& field )
+        {
+            if constexpr ( !is_computed_v<typename std::remove_cvref_t<M>::value_type::value_type> )
+                if ( field.value() ) s.template ref<std::remove_cvref_t<M>::tag()>() = *std::move( field ).value();
+        } );
+    }
+
+    ///
+    /// @brief Number of changed fields.
+    ///
+    std::size_t count() const noexcept
+    {
+        return fold_struct( fields_, std::size_t{0}, []<Member M>( std::size_t ans, M const& field ) noexcept { return ans + field.value().has_value(); } );
+    }
+
+    bool empty() const noexcept
+    {
+        return count() == 0;
+    }
+
+    static constexpr std::size_t size() noexcept
+    {
+        return sizeof...(Ms);
+    }
+};//struct struct_patch
+
+namespace detail
+{
+
+///
+/// @brief Equality of two values of a field: bytewise for a value whose bytes are its value and for a contiguous range of them, as `==` on structures does, `==` otherwise.
+///        A computed field is always equal, its dependencies are compared instead.
+///
+template< typename T >
+bool field_equal( T const& x, T const& y ) noexcept
+{
+    if constexpr ( is_computed_v<T> )
+        return true;
+    else if constexpr ( is_bulk_v<T> )
+        return std::memcmp( std::addressof( x ), std::addressof( y ), sizeof(T) ) == 0;
+    else if constexpr ( is_bulk_range<T>() )
+        return std::ranges::size( x ) == std::ranges::size( y ) &&
+               ( std::ranges::size( x ) == 0 || std::memcmp( std::ranges::data( x ), std::ranges::data( y ), std::ranges::size( x ) * sizeof(std::ranges::range_value_t<T const>) ) == 0 );
+    else
+        return x == y;
+}
+
+template< typename M >
+constexpr std::uint64_t fnv1a_patch_field( std::uint64_t hash ) noexcept
+{
+    if constexpr ( is_computed_v<typename M::value_type> ) return hash;
+    else return fnv1a_type<typename M::value_type>( fnv1a( tag_of<M::tag()>::value.view(), hash ) );
+}
+
+template< typename ... Ms >
+constexpr std::uint64_t patch_fingerprint( storage<Ms...> const* ) noexcept
+{
+    std::uint64_t hash = fnv1a( std::endian::native == std::endian::little ? "patch, little" : "patch, big" );
+    ( ( hash = fnv1a_patch_field<Ms>( hash ) ), ... );
+    return hash;
+}
+
+// the fingerprint of the patches of a schema: the tags and the types of the fields which are not computed
+template< Structure S >
+constexpr std::uint64_t patch_fingerprint_v = patch_fingerprint( static_cast<std::remove_cvref_t<decltype(std::declval<S const&>().s_)> const*>( nullptr ) );
+
+template< Structure S >
+constexpr std::size_t patch_mask_words = ( S::size() + 63 ) / 64;
+
+// bytes of a changed field in an encoded patch: the raw value, or the number of elements followed by the elements
+template< typename T >
+std::size_t patch_field_size( T const& value ) noexcept
+{
+    if constexpr ( wire_type<T>::raw ) return sizeof(T);
+    else return sizeof(std::uint64_t) + value.size() * sizeof(typename wire_type<T>::element_type);
+}
+
+template< typename T >
+std::byte* write_patch_field( std::byte* out, T const& value ) noexcept
+{
+    if constexpr ( wire_type<T>::raw )
+    {
+        std::memcpy( out, std::addressof( value ), sizeof(T) );
+        return out + sizeof(T);
+    }
+    else
+    {
+        std::uint64_t const length = value.size();
+        std::memcpy( out, &length, sizeof(length) );
+        out += sizeof(length);
+        if ( length > 0 )
+            std::memcpy( out, value.data(), length * sizeof(typename wire_type<T>::element_type) );
+        return out + length * sizeof(typename wire_type<T>::element_type);
+    }
+}
+
+// reads a field from [in, end), returns nullptr if it does not fit
+template< typename T >
+std::byte const* read_patch_field( std::byte const* in, std::byte const* end, std::optional<T>& value )
+{
+    if constexpr ( wire_type<T>::raw )
+    {
+        if ( static_cast<std::size_t>( end - in ) < sizeof(T) || !valid_raw<T>( in ) ) return nullptr;
+        T& ans = value.emplace();
+        std::memcpy( std::addressof( ans ), in, sizeof(T) );
+        return in + sizeof(T);
+    }
+    else
+    {
+        using E = typename wire_type<T>::element_type;
+        std::uint64_t length;
+        if ( static_cast<std::size_t>( end - in ) < sizeof(length) ) return nullptr;
+        std::memcpy( &length, in, sizeof(length) );
+        in += sizeof(length);
+        if ( length > static_cast<std::size_t>( end - in ) / sizeof(E) || !valid_raw<E>( in, length ) ) return nullptr;
+        T& ans = value.emplace( length, E{} );
+        if ( length > 0 )
+            std::memcpy( ans.data(), in, length * sizeof(E) );
+        return in + length * sizeof(E);
+    }
+}
+
+}//namespace detail
+
+///
+/// @brief DIFF two versions of a meta structure: the patch records the fields of `b` which differ from those of `a`, moved from `b` if it is an rvalue.
+/// Example:
+/// \code{.cpp}
+/// auto const patch = diff_struct( before, after );
+/// std::vector<std::byte> message = serialize_patch( patch ); // <-- only the changed fields
+/// \endcode
+///
+template< Structure S, Structure T >
+struct_patch<S> diff_struct( S const& a, T&& b )
+{
+    static_assert( std::is_same_v<S, std::remove_cvref_t<T>>, "diff_struct compares two structures of the same schema." );
+    struct_patch<S> patch;
+    [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+    {
+        ( [&]<std::size_t I>()
+        {
+            auto const& x = detail::get<I>( a.s_ ).value();
+            auto const& y = detail::get<I>( std::as_const( b ).s_ ).value();
+            if ( !detail::field_equal( x, y ) )
+            {
+                if constexpr ( std::is_reference_v<T> ) detail::get<I>( patch.fields_.s_ ).value().emplace( y );
+                else detail::get<I>( patch.fields_.s_ ).value().emplace( std::move( detail::get<I>( b.s_ ).value() ) );
+            }
+        }.template operator()<Is>(), ... );
+    }( std::make_index_sequence<S::size()>{} );
+    return patch;
+}
+
+///
+/// @brief APPLY a patch: the result has the changed fields of `patch` and the other fields of `s`, moved from `s` if it is an rvalue.
+///        The computed fields depending on a changed field are computed again on their next read.
+/// Example:
+/// \code{.cpp}
+/// replica = apply_patch( std::move( replica ), patch );
+/// \endcode
+///
+template< Structure S >
+std::remove_cvref_t<S> apply_patch( S&& s, struct_patch<std::remove_cvref_t<S>> const& patch )
+{
+    using schema_type = std::remove_cvref_t<S>;
+    return [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+    {
+        auto const patched = [&]<std::size_t I>() -> typename std::remove_cvref_t<decltype(detail::get<I>( s.s_ ))>::value_type
+        {
+            auto const& field = detail::get<I>( patch.fields_.s_ ).value();
+            if ( field ) return *field;
+            return detail::get<I>( std::forward<S>(s).s_ ).value();
+        };
+        schema_type ans{ detail::make_storage( std::remove_cvref_t<decltype(detail::get<Is>( s.s_ ))>{ patched.template operator()<Is>() }... ) };
+
+        // a computed field is stale if one of its dependencies changed
+        ( [&]<std::size_t I>()
+        {
+            auto const& field = detail::get<I>( ans.s_ ).value();
+            if constexpr ( is_computed_v<decltype(field)> )
+                if ( ( ( detail::computed_from<decltype(field), std::remove_cvref_t<decltype(detail::get<Is>( s.s_ ))>::tag()>() && detail::get<Is>( patch.fields_.s_ ).value().has_value() ) || ... ) )
+                    field.invalidate();
+        }.template operator()<Is>(), ... );
+        return ans;
+    }( std::make_index_sequence<schema_type::size()>{} );
+}
+
+///
+/// @brief Bytes taken by the encoded `patch`.
+///
+template< Structure S >
+std::size_t serialized_size( struct_patch<S> const& patch ) noexcept
+{
+    std::size_t ans = sizeof(wire_header) + detail::patch_mask_words<S> * sizeof(std::uint64_t);
+    for_each_field( patch.fields_, [&]<Member M>( M const& field ) noexcept
+    {
+        if constexpr ( !is_computed_v<typename M::value_type::value_type> )
+            if ( field.value() ) ans += detail::patch_field_size( *field.value() );
+    } );
+    return ans;
+}
+
+///
+/// @brief SERIALIZE a patch into `buffer`: a `wire_header`, a bit mask of the changed fields, then the changed fields only, without padding.
+///        Returns the bytes written, or 0 if `buffer` is too small. The buffer needs no alignment.
+/// Example:
+/// \code{.cpp}
+/// std::vector<std::byte> message = serialize_patch( diff_struct( before, after ) );
+/// \endcode
+///
+template< Structure S >
+std::size_t serialize_patch( struct_patch<S> const& patch, std::span<std::byte> buffer ) noexcept
+{
+    std::size_t const size = serialized_size( patch );
+    if ( buffer.size() < size )
+        return 0;
+
+    wire_header const header{ detail::patch_fingerprint_v<S>, size };
+    std::memcpy( buffer.data(), &header, sizeof(header) );
+    std::array<std::uint64_t, detail::patch_mask_words<S>> mask{};
+    std::byte* out = buffer.data() + sizeof(header) + sizeof(mask);
+    std::size_t index = 0;
+    for_each_field( patch.fields_, [&]<Member M>( M const& field ) noexcept
+    {
+        if constexpr ( !is_computed_v<typename M::value_type::value_type> )
+            if ( field.value() )
+            {
+                mask[index / 64] |= std::uint64_t{1} << ( index % 64 );
+                out = detail::write_patch_field( out, *field.value() );
+            }
+        ++index;
+    } );
+    std::memcpy( buffer.data() + sizeof(header), mask.data(), sizeof(mask) );
+    return size;
+}
+
+template< Structure S >
+std::vector<std::byte> serialize_patch( struct_patch<S> const& patch )
+{
+    std::vector<std::byte> buffer( serialized_size( patch ) );
+    serialize_patch( patch, std::span<std::byte>{ buffer } );
+    return buffer;
+}
+
+///
+/// @brief DESERIALIZE a patch of `Schema` from `buffer`.
+///        Returns `std::nullopt` if the buffer is truncated, holds a patch of another schema, or marks a computed field or a field beyond the schema.
+/// Example:
+/// \code{.cpp}
+/// if ( auto const patch = deserialize_patch<decltype(replica)>( std::span{ message } ) )
+///     replica = apply_patch( std::move( replica ), *patch );
+/// \endcode
+///
+template< Structure Schema >
+std::optional<struct_patch<Schema>> deserialize_patch( std::span<std::byte const> buffer )
+{
+    std::array<std::uint64_t, detail::patch_mask_words<Schema>> mask;
+    wire_header header;
+    if ( buffer.size() < sizeof(header) + sizeof(mask) )
+        return std::nullopt;
+    std::memcpy( &header, buffer.data(), sizeof(header) );
+    if ( header.fingerprint != detail::patch_fingerprint_v<Schema> || header.size < sizeof(header) + sizeof(mask) || header.size > buffer.size() )
+        return std::nullopt;
+    std::memcpy( mask.data(), buffer.data() + sizeof(header), sizeof(mask) );
+
+    struct_patch<Schema> patch;
+    std::byte const* in = buffer.data() + sizeof(header) + sizeof(mask);
+    std::byte const* const end = buffer.data() + header.size;
+    bool const ok = [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+    {
+        // a field is read if it is marked, and the reading stops at the first one which does not fit
+        return ( [&]<std::size_t I>()
+        {
+            if ( ( mask[I / 64] >> ( I % 64 ) & 1 ) == 0 ) return true;
+            auto& field = detail::get<I>( patch.fields_.s_ ).value();
+            if constexpr ( is_computed_v<typename std::remove_reference_t<decltype(field)>::value_type> )
+                return false;
+            else
+                return ( in = detail::read_patch_field( in, end, field ) ) != nullptr;
+        }.template operator()<Is>() && ... );
+    }( std::make_index_sequence<Schema::size()>{} );
+
+    // no mark beyond the fields, and no trailing byte
+    for ( std::size_t index = Schema::size(); ok && index < mask.size() * 64; ++index )
+        if ( mask[index / 64] >> ( index % 64 ) & 1 )
+            return std::nullopt;
+    if ( !ok || in != end )
+        return std::nullopt;
+    return patch;
+}
+
+}//namespace meta
+
+#endif//META_PATCH_HPP_INCLUDED_LKJHPOIUMNBVQWERASDFZXCV1122334455667788990AQ
@@ -0,0 +1,244 @@
+#ifndef META_PMR_HPP_INCLUDED_LKJHGFDSAPOIUYTREWQMNBVCXZ5647382910ZAQXSWCDE
+#define META_PMR_HPP_INCLUDED_LKJHGFDSAPOIUYTREWQMNBVCXZ5647382910ZAQXSWCDE
+
+#include "./meta_structure.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+namespace meta
+{
+
+///
+/// @brief A monotonic arena for the structures of one request: every allocation bumps a pointer, nothing is freed until `reset()` frees all at once.
+///        The first `capacity` bytes are taken from `upstream` once, and reused after each reset; a request allocating more grows into `upstream` until the next reset.
+///        Not thread safe, one arena per request or per thread. When the upstream is exhausted, the operation allocating in the arena throws `std::bad_alloc`.
+/// Example:
+/// \code{.cpp}
+/// struct_arena arena{ 64 * 1024 };
+/// for ( auto const& request : requests )
+/// {
+///     auto const s = create_struct( std::allocator_arg, &arena, make_member<"path">( std::pmr::string{ request.path } ) );
+///     handle( update_struct<"status">( std::allocator_arg, &arena, s, 200 ) );
+///     arena.reset();  // <-- the structures of this request must be gone
+/// }
+/// \endcode
+///
+class struct_arena : public std::pmr::memory_resource
+{
+    std::pmr::memory_resource* upstream_;
+    std::size_t capacity_;
+    void* buffer_;
+    std::pmr::monotonic_buffer_resource resource_;
+    std::size_t allocated_ = 0;
+    std::size_t peak_ = 0;
+
+    void* do_allocate( std::size_t bytes, std::size_t alignment ) override
+    {
+        void* ans = resource_.allocate( bytes, alignment );
+        allocated_ += bytes;
+        return ans;
+    }
+
+    // a monotonic arena frees nothing before `reset`
+    void do_deallocate( void*, std::size_t, std::size_t ) noexcept override {}
+
+    bool do_is_equal( std::pmr::memory_resource const& other ) const noexcept override
+    {
+        return this == &other;
+    }
+
+public:
+    explicit struct_arena( std::size_t capacity, std::pmr::memory_resource* upstream = std::pmr::get_default_resource() )
+        : upstream_( upstream ), capacity_( std::max<std::size_t>( capacity, 1 ) ), buffer_( upstream->allocate( capacity_, alignof(std::max_align_t) ) ),
+          resource_( buffer_, capacity_, upstream ) {}
+
+    struct_arena( struct_arena const& ) = delete;
+    struct_arena& operator = ( struct_arena const& ) = delete;
+
+    ~struct_arena() noexcept override
+    {
+        resource_.release();
+        upstream_->deallocate( buffer_, capacity_, alignof(std::max_align_t) );
+    }
+
+    ///
+    /// @brief Free every allocation since the last reset. The structures allocated in the arena must be destroyed, or never used again.
+    ///
+    void reset() noexcept
+    {
+        resource_.release();
+        peak_ = std::max( peak_, allocated_ );
+        allocated_ = 0;
+    }
+
+    std::size_t allocated() const noexcept { return allocated_; }                ///< bytes allocated since the last reset
+    std::size_t peak() const noexcept { return std::max( peak_, allocated_ ); }  ///< most bytes allocated between two resets, to size the arena
+    std::size_t capacity() const noexcept { return capacity_; }
+
+    std::pmr::polymorphic_allocator<> get_allocator() noexcept { return this; }
+};//class struct_arena
+
+template< Structure S >
+auto copy_struct( std::allocator_arg_t, std::pmr::polymorphic_allocator<> const& allocator, S&& structure );
+
+namespace detail
+{
+
+// a `T` constructed from `args` with `allocator` passed down to it and to its elements, when `T` uses one; a nested structure passes it to its fields
+template< typename T, typename ... Args >
+T make_with_allocator( std::pmr::polymorphic_allocator<> const& allocator, Args&& ... args )
+{
+    if constexpr ( is_structure_v<T> ) return copy_struct( std::allocator_arg, allocator, std::forward<Args>(args)... );
+    else return std::make_obj_using_allocator<T>( allocator, std::forward<Args>(args)... );
+}
+
+template< Member M >
+auto allocate_member( std::pmr::polymorphic_allocator<> const& allocator, M&& m )
+{
+    using value_type = typename std::remove_cvref_t<M>::value_type;
+    return member<std::remove_cvref_t<M>::tag(), value_type>{ make_with_allocator<value_type>( allocator, std::forward<M>(m).value() ) };
+}
+
+template< fixed_string tag_, typename T >
+auto allocate_member( std::pmr::polymorphic_allocator<> const& allocator, T&& value )
+{
+    return member<tag_, std::decay_t<T>>{ make_with_allocator<std::decay_t<T>>( allocator, std::forward<T>(value) ) };
+}
+
+}//namespace detail
+
+///
+/// @brief CREATE a meta structure as `create_struct` would, every field being constructed with `allocator`. Each field which uses an allocator,
+///        such as `std::pmr::string` or `std::pmr::vector<std::pmr::string>`, allocates in `allocator.resource()`, and passes it down to its own elements.
+///        Fields with a fixed allocator, such as `std::string`, still allocate from the heap.
+///        Every CRUD operation which constructs a new structure takes `std::allocator_arg` and an allocator the same way; without it, the `std::pmr` fields it copies allocate from the default resource.
+/// Example:
+/// \code{.cpp}
+/// std::pmr::monotonic_buffer_resource resource;
+/// auto const s = create_struct( std::allocator_arg, &resource, make_member<"name">( std::pmr::string{"meta"} ), make_member<"id">( 1 ) );
+/// \endcode
+///
+template< Member ... Members >
+auto create_struct( std::allocator_arg_t, std::pmr::polymorphic_allocator<> const& allocator, Members&& ... members )
+{
+    return create_struct( detail::allocate_member( allocator, std::forward<Members>(members) )... );
+}
+
+///
+/// @brief COPY a meta structure with `allocator`. The copy constructor of a `std::pmr` container allocates from the default resource, not from the resource of its source:
+///        this is the copy which stays in the arena.
+///
+template< Structure S >
+auto copy_struct( std::allocator_arg_t, std::pmr::polymorphic_allocator<> const& allocator, S&& structure )
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members )
+    {
+        return create_struct( detail::allocate_member( allocator, std::forward<MS>(members) )... );
+    } );
+}
+
+///
+/// @brief UPDATE a field as `update_struct` would, the new structure being constructed with `allocator`, field by field.
+///
+template< fixed_string tag_, Structure S, typename T >
+auto update_struct( std::allocator_arg_t, std::pmr::polymorphic_allocator<> const& allocator, S&& structure, T&& value )
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members )
+    {
+        constexpr std::size_t index = detail::index_of<tag_, std::remove_cvref_t<MS>...>();
+        auto const field = [&]<std::size_t I, Member M>( M&& m )
+        {
+            if constexpr ( I == index ) return detail::allocate_member<tag_>( allocator, std::forward<T>(value) );
+            else return detail::allocate_member( allocator, detail::keep_member<tag_>( std::forward<M>(m) ) );
+        };
+        if constexpr ( index < sizeof...(MS) )
+            return [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+            {
+                return create_struct( field.template operator()<Is>( std::forward<MS>(members) )... );
+            }( std::index_sequence_for<MS...>{} );
+        else
+            return create_struct( detail::allocate_member( allocator, std::forward<MS>(members) )..., detail::allocate_member<tag_>( allocator, std::forward<T>(value) ) );
+    } );
+}
+
+///
+/// @brief UPGRADE a field as `upgrade_struct` would, the new structure being constructed with `allocator`, field by field.
+///
+template< fixed_string tag_, Structure S, typename T >
+auto upgrade_struct( std::allocator_arg_t, std::pmr::polymorphic_allocator<> const& allocator, S&& structure, T&& value )
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members )
+    {
+        constexpr std::size_t index = detail::index_of<tag_, std::remove_cvref_t<MS>...>();
+        if constexpr ( index < sizeof...(MS) )
+            return [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+            {
+                return create_struct( detail::allocate_member( allocator, detail::upgrade_if<Is == index, tag_>( std::forward<MS>(members), std::forward<T>(value) ) )... );
+            }( std::index_sequence_for<MS...>{} );
+        else
+            return create_struct( detail::allocate_member( allocator, std::forward<MS>(members) )..., detail::allocate_member<tag_>( allocator, std::forward<T>(value) ) );
+    } );
+}
+
+///
+/// @brief DELETE a field as `delete_struct` would, the remaining fields being constructed with `allocator`.
+///
+template< fixed_string tag_, Structure S >
+auto delete_struct( std::allocator_arg_t, std::pmr::polymorphic_allocator<> const& allocator, S&& structure )
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members )
+    {
+        constexpr std::size_t index = detail::index_of<tag_, std::remove_cvref_t<MS>...>();
+        if constexpr ( index == sizeof...(MS) )
+            return create_struct( detail::allocate_member( allocator, std::forward<MS>(members) )... );
+        else
+        {
+            constexpr auto kept = detail::indices_without<sizeof...(MS), index>();
+            auto const pack = detail::make_pack( std::forward<MS>(members)... );
+            return [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+            {
+                return create_struct( detail::allocate_member( allocator, detail::at<kept[Is]>( pack ) )... );
+            }( std::make_index_sequence<sizeof...(MS)-1>{} );
+        }
+    } );
+}
+
+///
+/// @brief UPDATE several fields as `update_fields` would, the new structure being constructed with `allocator`, field by field.
+///
+template< Structure S, Member ... Us >
+auto update_fields( std::allocator_arg_t, std::pmr::polymorphic_allocator<> const& allocator, S&& structure, Us&& ... updates )
+{
+    static_assert( !detail::tag_table_v<std::remove_cvref_t<Us>::tag()...>.duplicate, "A tag is updated more than once." );
+    auto const pack = detail::make_pack( std::forward<Us>(updates)... );
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members )
+    {
+        constexpr std::array<bool, sizeof...(Us)> missing{ { ( detail::index_of<std::remove_cvref_t<Us>::tag(), std::remove_cvref_t<MS>...>() == sizeof...(MS) )... } };
+        constexpr std::size_t appended = std::count( missing.begin(), missing.end(), true );
+        constexpr auto positions = detail::marked_indices<appended>( missing );
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+        {
+            return create_struct( detail::allocate_member( allocator, detail::update_at<detail::index_of<std::remove_cvref_t<MS>::tag(), std::remove_cvref_t<Us>...>(), std::remove_cvref_t<Us>::tag()...>( std::forward<MS>(members), pack ) )...,
+                                  detail::allocate_member( allocator, detail::at<positions[Is]>( pack ) )... );
+        }( std::make_index_sequence<appended>{} );
+    } );
+}
+
+///
+/// @brief CONCATENATE meta structures as `concatenate_struct` would, every field being constructed with `allocator`.
+///
+template< Structure ... SS >
+auto concatenate_struct( std::allocator_arg_t, std::pmr::polymorphic_allocator<> const& allocator, SS&& ... ss )
+{
+    return detail::apply_all( [&]<Member ... MS>( MS&& ... members ) { return create_struct( detail::allocate_member( allocator, std::forward<MS>(members) )... ); }, std::forward<SS>(ss)... );
+}
+
+}//namespace meta
+
+#endif//META_PMR_HPP_INCLUDED_LKJHGFDSAPOIUYTREWQMNBVCXZ5647382910ZAQXSWCDE
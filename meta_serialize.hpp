@@ -0,0 +1,435 @@
+#ifndef META_SERIALIZE_HPP_INCLUDED_QPWOEIRUTYALSKDJFHGZMXNCBV0192837465LAKSJDHF
+#define META_SERIALIZE_HPP_INCLUDED_QPWOEIRUTYALSKDJFHGZMXNCBV0192837465LAKSJDHF
+
+#include "./meta_structure.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace meta
+{
+
+///
+/// @brief Header of a serialized meta structure, followed by the fixed region of the fields and by the blob of their contents.
+///        Everything is in host byte order, which is part of the fingerprint.
+///
+struct wire_header
+{
+    std::uint64_t fingerprint;  ///< hash of the tags and of the types of the fields
+    std::uint64_t size;         ///< bytes of the header, the fixed region and the blob
+};//struct wire_header
+
+///
+/// @brief Position of a string or a vector in the blob: offset from the start of the header, and number of elements.
+///
+struct wire_slot
+{
+    std::uint64_t offset;
+    std::uint64_t length;
+};//struct wire_slot
+
+namespace detail
+{
+
+template< typename T >
+struct is_std_array : std::false_type {};
+
+template< typename T, std::size_t N >
+struct is_std_array< std::array<T, N> > : std::true_type {};
+
+// a scoped enum has a fixed underlying type, so that every value of this type is a value of the enum
+template< typename T >
+constexpr bool is_scoped_enum() noexcept
+{
+    if constexpr ( std::is_enum_v<T> ) return !std::is_convertible_v<T, std::underlying_type_t<T>>;
+    else return false;
+}
+
+///
+/// @brief Types whose bytes are their value in another process: arithmetic types, scoped enums, arrays of them, and meta structures of them.
+///        Trivially copyable types holding an address, such as `std::string_view`, `std::span` or a struct with a pointer, are not,
+///        nor are unscoped enums, which may have no value for some bytes of their underlying type.
+///
+template< typename T >
+constexpr bool is_raw_wire() noexcept
+{
+    if constexpr ( std::is_arithmetic_v<T> || is_scoped_enum<T>() ) return true;
+    else if constexpr ( std::is_array_v<T> ) return is_raw_wire<std::remove_extent_t<T>>();
+    else if constexpr ( is_std_array<T>::value ) return is_raw_wire<typename T::value_type>();
+    else if constexpr ( is_structure_v<T> )
+        return []<typename ... Ms>( storage<Ms...>* ) { return ( is_raw_wire<typename Ms::value_type>() && ... ); }( static_cast<decltype(T::s_)*>( nullptr ) );
+    else return false;
+}
+
+// true if a raw type holds a `bool`, which has no value for the bytes other than 0 and 1
+template< typename T >
+constexpr bool holds_bool() noexcept
+{
+    if constexpr ( std::is_same_v<T, bool> ) return true;
+    else if constexpr ( std::is_array_v<T> ) return holds_bool<std::remove_extent_t<T>>();
+    else if constexpr ( is_std_array<T>::value ) return holds_bool<typename T::value_type>();
+    else if constexpr ( is_structure_v<T> )
+        return []<typename ... Ms>( storage<Ms...>* ) { return ( holds_bool<typename Ms::value_type>() || ... ); }( static_cast<decltype(T::s_)*>( nullptr ) );
+    else return false;
+}
+
+///
+/// @brief True if the `count` raw values of type `T` at `bytes`, e.g. read from an untrusted buffer, are values: every `bool` they hold is 0 or 1.
+///
+template< typename T >
+bool valid_raw( std::byte const* bytes, std::size_t count = 1 ) noexcept
+{
+    if constexpr ( !holds_bool<T>() )
+        return true;
+    else
+    {
+        for ( std::size_t index = 0; index != count; ++index )
+        {
+            std::byte const* const value = bytes + index * sizeof(T);
+            bool valid = true;
+            if constexpr ( std::is_same_v<T, bool> )
+                valid = std::to_integer<unsigned>( *value ) <= 1;
+            else if constexpr ( std::is_array_v<T> )
+                valid = valid_raw<std::remove_extent_t<T>>( value, std::extent_v<T> );
+            else if constexpr ( is_std_array<T>::value )
+                valid = valid_raw<typename T::value_type>( value, std::tuple_size_v<T> );
+            else
+                valid = [&]<typename ... Ms, std::size_t ... Is>( storage<Ms...>*, std::index_sequence<Is...> )
+                {
+                    constexpr auto offsets = layout_of<T>().offsets;
+                    return ( valid_raw<typename Ms::value_type>( value + offsets[Is] ) && ... );
+                }( static_cast<decltype(T::s_)*>( nullptr ), std::make_index_sequence<T::size()>{} );
+            if ( !valid )
+                return false;
+        }
+        return true;
+    }
+}
+
+template< typename T >
+struct wire_type
+{
+    static_assert( is_raw_wire<T>(), "This field type cannot be serialized: only arithmetic types, scoped enums, arrays and meta structures of them, strings and vectors of them are." );
+    static constexpr bool raw = true;
+    typedef T element_type;
+};
+
+template<>
+struct wire_type< std::string >
+{
+    static constexpr bool raw = false;
+    typedef char element_type;
+};
+
+template< typename T >
+struct wire_type< std::vector<T> >
+{
+    static_assert( is_raw_wire<T>() && !std::is_same_v<T, bool>, "This vector element type cannot be serialized." );
+    static constexpr bool raw = false;
+    typedef T element_type;
+};
+
+constexpr std::uint64_t fnv1a_number( std::uint64_t value, std::uint64_t hash ) noexcept
+{
+    char bytes[8] = {};
+    for ( char& byte : bytes )
+    {
+        byte = static_cast<char>( value & 0xff );
+        value >>= 8;
+    }
+    return fnv1a( std::string_view{ bytes, 8 }, hash );
+}
+
+///
+/// @brief Continue `hash` with the shape of a type: the kind, size and alignment of a scalar, or the container and its element type.
+///
+template< typename T >
+constexpr std::uint64_t fnv1a_type( std::uint64_t hash ) noexcept
+{
+    if constexpr ( std::is_same_v<T, std::string> ) return fnv1a( "string", hash );
+    else if constexpr ( !wire_type<T>::raw ) return fnv1a_type<typename wire_type<T>::element_type>( fnv1a( "vector", hash ) );
+    else if constexpr ( is_structure_v<T> )
+        return []<typename ... Ms>( storage<Ms...>*, std::uint64_t h ) noexcept
+        {
+            ( ( h = fnv1a_type<typename Ms::value_type>( fnv1a( tag_of<Ms::tag()>::value.view(), h ) ) ), ... );
+            return fnv1a_number( sizeof(T), h );
+        }( static_cast<decltype(T::s_)*>( nullptr ), fnv1a( "struct", hash ) );
+    else
+    {
+        std::string_view const kind = std::is_same_v<T, bool> ? "bool" : std::is_floating_point_v<T> ? "float" : std::is_signed_v<T> ? "int" : std::is_unsigned_v<T> ? "unsigned" : "bytes";
+        return fnv1a_number( alignof(T), fnv1a_number( sizeof(T), fnv1a( kind, hash ) ) );
+    }
+}
+
+template< typename S >
+struct wire_schema;
+
+///
+/// @brief Wire layout of a storage: raw fields are stored at their alignment, strings and vectors as a `wire_slot`.
+///
+template< typename ... Ms >
+struct wire_schema< storage<Ms...> >
+{
+    static constexpr std::size_t size = sizeof...(Ms);
+
+    static constexpr std::uint64_t fingerprint = []() noexcept
+    {
+        std::uint64_t hash = fnv1a( std::endian::native == std::endian::little ? "little" : "big" );
+        ( ( hash = fnv1a_type<typename Ms::value_type>( fnv1a( tag_of<Ms::tag()>::value.view(), hash ) ) ), ... );
+        return hash;
+    }();
+
+    // the offsets of the fields, and the end of the last one
+    static constexpr std::array<std::size_t, size+1> offsets = []() noexcept
+    {
+        std::array<std::size_t, size+1> ans{};
+        std::size_t offset = sizeof(wire_header);
+        std::size_t index = 0;
+        ( ( offset = round_up( offset, wire_type<typename Ms::value_type>::raw ? alignof(typename Ms::value_type) : alignof(wire_slot) ),
+            ans[index++] = offset,
+            offset += wire_type<typename Ms::value_type>::raw ? sizeof(typename Ms::value_type) : sizeof(wire_slot) ), ... );
+        ans[size] = offset;
+        return ans;
+    }();
+
+    // the blob starts after the fixed region, and a buffer has to be aligned for every field
+    static constexpr std::size_t alignment = std::max( { alignof(wire_header), alignof(typename wire_type<typename Ms::value_type>::element_type)... } );
+    static constexpr std::size_t fixed_size = round_up( offsets[size], alignment );
+
+    template< std::size_t I >
+    using member_type = type_at<I, Ms...>;
+
+    template< std::size_t I >
+    using value_type = typename member_type<I>::value_type;
+};
+
+template< typename S >
+using wire_schema_of = wire_schema<std::remove_cvref_t<decltype(std::declval<S const&>().s_)>>;
+
+// bytes used by a field in the blob, starting from `offset`
+template< typename T >
+constexpr std::size_t blob_end( std::size_t offset, T const& value ) noexcept
+{
+    if constexpr ( wire_type<T>::raw ) return offset;
+    else return round_up( offset, alignof(typename wire_type<T>::element_type) ) + value.size() * sizeof(typename wire_type<T>::element_type);
+}
+
+// writes `value` at `offset` of the fixed region, and its contents at `cursor` in the blob
+template< typename T >
+void write_field( std::byte* buffer, std::size_t offset, T const& value, std::size_t& cursor ) noexcept
+{
+    if constexpr ( wire_type<T>::raw )
+        std::memcpy( buffer + offset, &value, sizeof(T) );
+    else
+    {
+        cursor = round_up( cursor, alignof(typename wire_type<T>::element_type) );
+        wire_slot const slot{ cursor, value.size() };
+        std::memcpy( buffer + offset, &slot, sizeof(slot) );
+        if ( value.size() > 0 )
+            std::memcpy( buffer + cursor, value.data(), value.size() * sizeof(typename wire_type<T>::element_type) );
+        cursor += value.size() * sizeof(typename wire_type<T>::element_type);
+    }
+}
+
+inline wire_slot read_slot( std::byte const* buffer, std::size_t offset ) noexcept
+{
+    wire_slot slot;
+    std::memcpy( &slot, buffer + offset, sizeof(slot) );
+    return slot;
+}
+
+}//namespace detail
+
+///
+/// @brief Bytes taken by the serialized meta structure `s`.
+///
+template< Structure S >
+std::size_t serialized_size( S const& s ) noexcept
+{
+    using schema = detail::wire_schema_of<S>;
+    return s( [&]<Member ... MS>( MS const& ... members ) noexcept
+    {
+        std::size_t cursor = schema::fixed_size;
+        ( ( cursor = detail::blob_end( cursor, members.value() ) ), ... );
+        return cursor;
+    } );
+}
+
+///
+/// @brief SERIALIZE a meta structure into `buffer`, which should be aligned as `detail::wire_schema_of<S>::alignment`.
+///        Returns the bytes written, or 0 if `buffer` is too small.
+/// Example:
+/// \code{.cpp}
+/// auto const s = create_struct( make_member<"id">( 1 ), make_member<"name">( std::string{"meta"} ) );
+/// std::vector<std::byte> buffer = serialize_struct( s );
+/// \endcode
+///
+template< Structure S >
+std::size_t serialize_struct( S const& s, std::span<std::byte> buffer ) noexcept
+{
+    using schema = detail::wire_schema_of<S>;
+    std::size_t const size = serialized_size( s );
+    if ( buffer.size() < size )
+        return 0;
+
+    // the padding is zeroed, so that equal structures serialize to equal bytes
+    std::memset( buffer.data(), 0, size );
+    wire_header const header{ schema::fingerprint, size };
+    std::memcpy( buffer.data(), &header, sizeof(header) );
+    s( [&]<Member ... MS>( MS const& ... members ) noexcept
+    {
+        std::size_t cursor = schema::fixed_size;
+        std::size_t index = 0;
+        ( detail::write_field( buffer.data(), schema::offsets[index++], members.value(), cursor ), ... );
+    } );
+    return size;
+}
+
+template< Structure S >
+std::vector<std::byte> serialize_struct( S const& s )
+{
+    std::vector<std::byte> buffer( serialized_size( s ) );
+    serialize_struct( s, std::span<std::byte>{ buffer } );
+    return buffer;
+}
+
+///
+/// @brief Read-only view of a meta structure serialized in a buffer, the fields are read in place.
+///        Raw fields are returned by value, strings as `std::string_view` and vectors as `std::span<T const>` into the buffer.
+///
+template< Structure Schema >
+class struct_view
+{
+    typedef detail::wire_schema_of<Schema> schema;
+
+    std::span<std::byte const> buffer_;
+
+    template< fixed_string tag_ >
+    static constexpr std::size_t index() noexcept
+    {
+        constexpr std::size_t index = detail::index_of_tag<tag_, std::remove_cvref_t<decltype(std::declval<Schema const&>().s_)>>::value;
+        static_assert( index < Schema::size(), "This field is not defined in the structure." );
+        return index;
+    }
+
+    template< std::size_t I >
+    auto field() const noexcept
+    {
+        using T = typename schema::template value_type<I>;
+        if constexpr ( detail::wire_type<T>::raw )
+        {
+            T value;
+            std::memcpy( &value, buffer_.data() + schema::offsets[I], sizeof(T) );
+            return value;
+        }
+        else
+        {
+            using E = typename detail::wire_type<T>::element_type;
+            wire_slot const slot = detail::read_slot( buffer_.data(), schema::offsets[I] );
+            // the slots are checked by `view_struct`, the elements are trivially copyable and suitably aligned
+            E const* first = reinterpret_cast<E const*>( buffer_.data() + slot.offset );
+            if constexpr ( std::is_same_v<T, std::string> )
+                return std::string_view{ first, slot.length };
+            else
+                return std::span<E const>{ first, slot.length };
+        }
+    }
+
+    template< std::size_t I >
+    bool valid_slot() const noexcept
+    {
+        using T = typename schema::template value_type<I>;
+        if constexpr ( detail::wire_type<T>::raw )
+            return detail::valid_raw<T>( buffer_.data() + schema::offsets[I] );
+        else
+        {
+            using E = typename detail::wire_type<T>::element_type;
+            wire_slot const slot = detail::read_slot( buffer_.data(), schema::offsets[I] );
+            return slot.offset >= schema::fixed_size && slot.offset <= buffer_.size() && slot.offset % alignof(E) == 0 &&
+                   slot.length <= ( buffer_.size() - slot.offset ) / sizeof(E) && detail::valid_raw<E>( buffer_.data() + slot.offset, slot.length );
+        }
+    }
+
+    explicit struct_view( std::span<std::byte const> buffer ) noexcept : buffer_{ buffer } {}
+
+    template< Structure S >
+    friend std::optional<struct_view<S>> view_struct( std::span<std::byte const> buffer ) noexcept;
+
+public:
+    template< fixed_string tag_ >
+    auto read() const noexcept
+    {
+        return field<index<tag_>()>();
+    }
+
+    template< fixed_string tag_ >
+    static constexpr bool has() noexcept
+    {
+        return detail::index_of_tag<tag_, std::remove_cvref_t<decltype(std::declval<Schema const&>().s_)>>::value < Schema::size();
+    }
+
+    static constexpr std::size_t size() noexcept { return Schema::size(); }
+
+    /// the serialized bytes, header included
+    std::span<std::byte const> bytes() const noexcept { return buffer_; }
+
+    /// copies the fields into a meta structure, strings and vectors are allocated
+    Schema to_struct() const
+    {
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+        {
+            return Schema{ detail::make_storage( typename schema::template member_type<Is>{ to_value<Is>() }... ) };
+        }( std::make_index_sequence<Schema::size()>{} );
+    }
+
+private:
+    template< std::size_t I >
+    auto to_value() const
+    {
+        using T = typename schema::template value_type<I>;
+        auto const value = field<I>();
+        if constexpr ( detail::wire_type<T>::raw ) return value;
+        else return T( value.begin(), value.end() );
+    }
+};//class struct_view
+
+///
+/// @brief VIEW a meta structure serialized in `buffer`, e.g. a received message or an `mmap`ed file, without deserializing nor allocating.
+///        Returns `std::nullopt` if the buffer does not hold a structure of `Schema`: it is too short, misaligned, has another fingerprint, a string or a vector out of its bounds,
+///        or a `bool` which is neither 0 nor 1.
+/// Example:
+/// \code{.cpp}
+/// if ( auto const view = view_struct<decltype(s)>( std::span{ buffer } ) )
+///     std::string_view name = view->read<"name">();
+/// \endcode
+///
+template< Structure Schema >
+std::optional<struct_view<Schema>> view_struct( std::span<std::byte const> buffer ) noexcept
+{
+    using schema = detail::wire_schema_of<Schema>;
+    if ( buffer.size() < schema::fixed_size || reinterpret_cast<std::uintptr_t>( buffer.data() ) % schema::alignment != 0 )
+        return std::nullopt;
+
+    wire_header header;
+    std::memcpy( &header, buffer.data(), sizeof(header) );
+    if ( header.fingerprint != schema::fingerprint || header.size < schema::fixed_size || header.size > buffer.size() )
+        return std::nullopt;
+
+    struct_view<Schema> const view{ buffer.first( header.size ) };
+    bool const valid = [&]<std::size_t ... Is>( std::index_sequence<Is...> ) { return ( view.template valid_slot<Is>() && ... ); }( std::make_index_sequence<Schema::size()>{} );
+    if ( !valid )
+        return std::nullopt;
+    return view;
+}
+
+}//namespace meta
+
+#endif//META_SERIALIZE_HPP_INCLUDED_QPWOEIRUTYALSKDJFHGZMXNCBV0192837465LAKSJDHF
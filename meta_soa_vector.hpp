@@ -0,0 +1,382 @@
+#ifndef META_SOA_VECTOR_HPP_INCLUDED_PLKAJSDFO8U3LKJASDFLKJQWE09UASDLKFJALSKDJF
+#define META_SOA_VECTOR_HPP_INCLUDED_PLKAJSDFO8U3LKJASDFLKJQWE09UASDLKFJALSKDJF
+
+#include "./meta_structure.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define META_STRUCTURE_HAS_SIMD 1
+#endif
+
+namespace meta
+{
+
+template< Structure Schema >
+class soa_vector;
+
+///
+/// @brief A struct-of-arrays container, each field of `Schema` is stored in its own contiguous column.
+///        All the columns share one allocation, and every column starts at a `column_alignment` boundary.
+///        When copying or moving a field throws, `push_back`, `reserve` and `resize` leave the vector as it was: rows are moved into a larger block only if
+///        their move does not throw, and copied otherwise.
+/// Example:
+/// \code{.cpp}
+/// auto constexpr prototype = create_struct( make_member<"x">( 0.0f ), make_member<"id">( 0 ) );
+/// soa_vector<decltype(prototype)> v;
+/// v.push_back( prototype );
+/// std::span<float> xs = v.col<"x">();
+/// v[0].update<"x">( 1.0f );
+/// \endcode
+///
+template< typename ... Ms >
+class soa_vector< structure<detail::storage<Ms...>> >
+{
+public:
+    typedef structure<detail::storage<Ms...>> schema_type;
+    static constexpr std::size_t column_alignment = std::max( { std::size_t{64}, alignof(typename Ms::value_type)... } );
+
+private:
+    static constexpr std::size_t columns = sizeof...(Ms);
+
+    template< std::size_t I >
+    using column_type = typename detail::type_at<I, Ms...>::value_type;
+
+    template< fixed_string tag_ >
+    static constexpr std::size_t column_index() noexcept
+    {
+        constexpr std::size_t index = detail::index_of<tag_, Ms...>();
+        static_assert( index < columns, "This field is not defined in the structure." );
+        return index;
+    }
+
+    // offsets of the columns in a block holding `capacity` rows, the last one being the size of the block
+    static constexpr std::array<std::size_t, columns+1> column_offsets( std::size_t capacity ) noexcept
+    {
+        std::array<std::size_t, columns+1> offsets{};
+        std::size_t index = 0;
+        ( ( offsets[index+1] = detail::round_up( offsets[index] + capacity * sizeof(typename Ms::value_type), column_alignment ), ++index ), ... );
+        return offsets;
+    }
+
+    std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+    std::array<std::size_t, columns+1> offsets_{};
+
+    template< std::size_t I >
+    column_type<I>* column() const noexcept
+    {
+        return reinterpret_cast<column_type<I>*>( data_ + offsets_[I] );
+    }
+
+    template< typename F >
+    void for_each_column( F&& function ) const
+    {
+        [&]<std::size_t ... Is>( std::index_sequence<Is...> ) { ( function( column<Is>() ), ... ); }( std::make_index_sequence<columns>{} );
+    }
+
+    // calls `construct.template operator()<I>()` for each column in order. If one throws, `destroy.template operator()<I>()` undoes the columns
+    // constructed before it, and the exception is rethrown: a column is either constructed for every row or for none
+    template< typename C, typename D >
+    static void construct_columns( C&& construct, D&& destroy )
+    {
+        std::size_t constructed = 0;
+        [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+        {
+            try
+            {
+                ( ( construct.template operator()<Is>(), ++constructed ), ... );
+            }
+            catch ( ... )
+            {
+                ( ( Is < constructed ? destroy.template operator()<Is>() : void() ), ... );
+                throw;
+            }
+        }( std::make_index_sequence<columns>{} );
+    }
+
+    // moves the rows into a new block of `capacity` rows; they are copied if their move may throw, so that the rows are intact when it throws
+    void reallocate( std::size_t capacity )
+    {
+        auto const offsets = column_offsets( capacity );
+        std::byte* data = static_cast<std::byte*>( ::operator new( offsets[columns], std::align_val_t{column_alignment} ) );
+        auto const target = [&]<std::size_t I>() { return reinterpret_cast<column_type<I>*>( data + offsets[I] ); };
+        try
+        {
+            construct_columns( [&]<std::size_t I>()
+            {
+                if constexpr ( std::is_nothrow_move_constructible_v<column_type<I>> || !std::is_copy_constructible_v<column_type<I>> )
+                    std::uninitialized_move_n( column<I>(), size_, target.template operator()<I>() );
+                else
+                    std::uninitialized_copy_n( column<I>(), size_, target.template operator()<I>() );
+            }, [&]<std::size_t I>() { std::destroy_n( target.template operator()<I>(), size_ ); } );
+        }
+        catch ( ... )
+        {
+            ::operator delete( data, std::align_val_t{column_alignment} );
+            throw;
+        }
+        release();
+        data_ = data;
+        capacity_ = capacity;
+        offsets_ = offsets;
+    }
+
+    void release() noexcept
+    {
+        if ( data_ == nullptr ) return;
+        for_each_column( [&]( auto* col ) { std::destroy_n( col, size_ ); } );
+        ::operator delete( data_, std::align_val_t{column_alignment} );
+        data_ = nullptr;
+    }
+
+    template< typename S >
+    void construct_back( S&& s )
+    {
+        if ( size_ == capacity_ )
+            reallocate( capacity_ == 0 ? 8 : capacity_ * 2 );
+        std::forward<S>(s)( [&]<typename ... MS>( MS&& ... members )
+        {
+            auto const pack = std::forward_as_tuple( std::forward<MS>(members)... );
+            construct_columns( [&]<std::size_t I>() { std::construct_at( column<I>() + size_, std::get<I>( std::move( pack ) ).value() ); },
+                               [&]<std::size_t I>() { std::destroy_at( column<I>() + size_ ); } );
+        } );
+        ++size_;
+    }
+
+public:
+    ///
+    /// @brief Proxy to one row, with the `read/update/has` vocabulary of `structure`. `update` assigns in place.
+    ///
+    template< bool const_ >
+    struct basic_row
+    {
+        std::conditional_t<const_, soa_vector const*, soa_vector*> vector_;
+        std::size_t index_;
+
+        template< fixed_string tag_ >
+        decltype(auto) read() const noexcept
+        {
+            if constexpr ( const_ )
+                return static_cast<column_type<column_index<tag_>()> const&>( vector_->template column<column_index<tag_>()>()[index_] );
+            else
+                return ( vector_->template column<column_index<tag_>()>()[index_] );
+        }
+
+        template< fixed_string tag_, typename T >
+        requires ( !const_ )
+        basic_row const& update( T&& value ) const
+        {
+            read<tag_>() = std::forward<T>(value);
+            return *this;
+        }
+
+        template< fixed_string tag_ >
+        static constexpr bool has() noexcept
+        {
+            return detail::index_of<tag_, Ms...>() < columns;
+        }
+
+        operator schema_type() const
+        {
+            return [&]<std::size_t ... Is>( std::index_sequence<Is...> )
+            {
+                return schema_type{ detail::make_storage( Ms{ vector_->template column<Is>()[index_] }... ) };
+            }( std::make_index_sequence<columns>{} );
+        }
+    };//struct basic_row
+
+    typedef basic_row<false> row;
+    typedef basic_row<true> const_row;
+
+    soa_vector() noexcept = default;
+
+    explicit soa_vector( schema_type const& ) noexcept {}
+
+    soa_vector( soa_vector const& other ) : soa_vector()
+    {
+        reserve( other.size_ );
+        construct_columns( [&]<std::size_t I>() { std::uninitialized_copy_n( other.template column<I>(), other.size_, column<I>() ); },
+                           [&]<std::size_t I>() { std::destroy_n( column<I>(), other.size_ ); } );
+        size_ = other.size_;
+    }
+
+    soa_vector( soa_vector&& other ) noexcept
+    {
+        swap( other );
+    }
+
+    soa_vector& operator = ( soa_vector other ) noexcept
+    {
+        swap( other );
+        return *this;
+    }
+
+    ~soa_vector() noexcept
+    {
+        release();
+    }
+
+    void swap( soa_vector& other ) noexcept
+    {
+        std::swap( data_, other.data_ );
+        std::swap( size_, other.size_ );
+        std::swap( capacity_, other.capacity_ );
+        std::swap( offsets_, other.offsets_ );
+    }
+
+    std::size_t size() const noexcept { return size_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    void reserve( std::size_t capacity )
+    {
+        if ( capacity > capacity_ )
+            reallocate( capacity );
+    }
+
+    ///
+    /// @brief Resize to `size` rows, the new rows are value-initialized in every column.
+    ///
+    void resize( std::size_t size )
+    {
+        if ( size > capacity_ )
+            reallocate( std::max( size, capacity_ * 2 ) );
+        if ( size > size_ )
+            construct_columns( [&]<std::size_t I>() { std::uninitialized_value_construct( column<I>() + size_, column<I>() + size ); },
+                               [&]<std::size_t I>() { std::destroy( column<I>() + size_, column<I>() + size ); } );
+        else
+            for_each_column( [&]( auto* col ) { std::destroy( col + size, col + size_ ); } );
+        size_ = size;
+    }
+
+    ///
+    /// @brief Move the rows of `other` to the back, column by column. `other` is left empty.
+    ///
+    void append( soa_vector&& other )
+    {
+        if ( size_ + other.size_ > capacity_ )
+            reallocate( std::max( size_ + other.size_, capacity_ * 2 ) );
+        construct_columns( [&]<std::size_t I>() { std::uninitialized_move_n( other.template column<I>(), other.size_, column<I>() + size_ ); },
+                           [&]<std::size_t I>() { std::destroy_n( column<I>() + size_, other.size_ ); } );
+        size_ += other.size_;
+        other.clear();
+    }
+
+    void push_back( schema_type const& s ) { construct_back( s ); }
+    void push_back( schema_type&& s ) { construct_back( std::move(s) ); }
+
+    void pop_back() noexcept
+    {
+        --size_;
+        for_each_column( [&]( auto* col ) { std::destroy_at( col + size_ ); } );
+    }
+
+    ///
+    /// @brief Erase the rows [first, last), the following rows are moved down in each column.
+    ///
+    void erase( std::size_t first, std::size_t last ) noexcept( ( std::is_nothrow_move_assignable_v<typename Ms::value_type> && ... ) )
+    {
+        for_each_column( [&]( auto* col )
+        {
+            std::move( col + last, col + size_, col + first );
+            std::destroy( col + size_ - ( last - first ), col + size_ );
+        } );
+        size_ -= last - first;
+    }
+
+    void erase( std::size_t index ) noexcept( ( std::is_nothrow_move_assignable_v<typename Ms::value_type> && ... ) )
+    {
+        erase( index, index + 1 );
+    }
+
+    void clear() noexcept
+    {
+        for_each_column( [&]( auto* col ) { std::destroy_n( col, size_ ); } );
+        size_ = 0;
+    }
+
+    template< fixed_string tag_ >
+    std::span<column_type<column_index<tag_>()>> col() noexcept
+    {
+        return { column<column_index<tag_>()>(), size_ };
+    }
+
+    template< fixed_string tag_ >
+    std::span<column_type<column_index<tag_>()> const> col() const noexcept
+    {
+        return { column<column_index<tag_>()>(), size_ };
+    }
+
+    row operator[]( std::size_t index ) noexcept { return row{ this, index }; }
+    const_row operator[]( std::size_t index ) const noexcept { return const_row{ this, index }; }
+
+    row back() noexcept { return (*this)[size_-1]; }
+    const_row back() const noexcept { return (*this)[size_-1]; }
+
+};//class soa_vector
+
+template< Structure S >
+soa_vector( S const& ) -> soa_vector<S>;
+
+namespace detail
+{
+
+template< fixed_string tag_, typename T, typename F >
+void map_column( std::span<T> column, F& function )
+{
+    std::size_t index = 0;
+#ifdef META_STRUCTURE_HAS_SIMD
+    if constexpr ( std::is_arithmetic_v<T> && !std::is_same_v<T, bool> )
+    {
+        using vector_type = std::experimental::native_simd<T>;
+        if constexpr ( std::is_invocable_r_v<vector_type, F&, member<tag_, vector_type> const&> )
+        {
+            // columns start on a cache line, so every full vector is aligned
+            for ( ; index + vector_type::size() <= column.size(); index += vector_type::size() )
+            {
+                vector_type const vec( column.data() + index, std::experimental::vector_aligned );
+                vector_type const ans = function( member<tag_, vector_type>{ vec } );
+                ans.copy_to( column.data() + index, std::experimental::vector_aligned );
+            }
+        }
+    }
+#endif
+    if constexpr ( std::is_invocable_v<F&, member<tag_, T> const&> )
+        for ( ; index < column.size(); ++index )
+            column[index] = function( member<tag_, T>{ std::move( column[index] ) } );
+}
+
+}//namespace detail
+
+///
+/// @brief MAP a function to each field of every row in a batch, in place.
+///        Arithmetic columns are processed by SIMD vectors when `function` accepts a `member<tag, simd<T>>`, with a scalar loop for the remainder.
+///        Columns whose member type `function` does not accept are left untouched. Acceptance is tested by `std::is_invocable`, which sees a constraint
+///        but instantiates the body of a generic lambda with a deduced return type: such a lambda must be constrained to the members it can map.
+/// Example:
+/// \code{.cpp}
+/// soa_vector<decltype(prototype)> batch;
+/// // arithmetic columns and their SIMD vectors, a `std::string` column is skipped
+/// map_columns( batch, []<Member M>( M const& m ) requires ( !std::is_same_v<typename M::value_type, std::string> ) { return m.value() * typename M::value_type( 2 ); } );
+/// \endcode
+///
+template< Structure S, typename F >
+void map_columns( soa_vector<S>& batch, F&& function )
+{
+    [&]<typename ... Ms>( detail::storage<Ms...>* )
+    {
+        ( detail::map_column<Ms::tag()>( batch.template col<Ms::tag()>(), function ), ... );
+    }( static_cast<decltype(std::declval<S&>().s_)*>( nullptr ) );
+}
+
+}//namespace meta
+
+#endif//META_SOA_VECTOR_HPP_INCLUDED_PLKAJSDFO8U3LKJASDFLKJQWE09UASDLKFJALSKDJF
@@ -2,26 +2,70 @@
 #define META_STRUCTURE_HPP_INCLUDED_ASDLJOP4IJALKJASLKJDASFLKSDJSADFKJASDFOKJSDF
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <type_traits>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace meta
 {
 
+namespace detail
+{
+
+///
+/// @brief 64-bit FNV-1a hash of a string, `hash` continues the hash of the strings before it.
+///
+constexpr std::uint64_t fnv1a( std::string_view str, std::uint64_t hash = 0xcbf29ce484222325ULL ) noexcept
+{
+    for ( char ch : str )
+    {
+        hash ^= static_cast<unsigned char>( ch );
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+}//namespace detail
+
+///
+/// @brief A tag. Its 64-bit `hash()` is the key of the tag in the perfect-hash tables of the structures.
+///        The hash is not stored, so that it does not lengthen the mangled names of the types tagged by this string.
+///
 template< unsigned long N>
 struct fixed_string
 {
     char data[N + 1] = {};
     constexpr fixed_string(const char (&foo)[N + 1]) { std::copy_n(foo, N + 1, data); }
-    auto operator<=>(const fixed_string&) const = default;
+    constexpr std::string_view view() const noexcept { return std::string_view{ data }; }
+    constexpr std::uint64_t hash() const noexcept { return detail::fnv1a( view() ); }
     constexpr operator std::string() const noexcept { return std::string(data); }
 };//struct fixed_string
 
+// tags of different lengths are equal if they hold the same string, e.g. "ab\0" and "ab"
+template< unsigned long M, unsigned long N >
+constexpr bool operator == (const fixed_string<M>& lhs, const fixed_string<N>& rhs) noexcept
+{
+    return lhs.view() == rhs.view();
+}
+
+// ordered as their strings, consistently with `==`, e.g. to sort tags
 template< unsigned long M, unsigned long N >
-constexpr bool operator == (const fixed_string<M>&, const fixed_string<N>&) noexcept
+constexpr std::strong_ordering operator <=> (const fixed_string<M>& lhs, const fixed_string<N>& rhs) noexcept
 {
-    return false;
+    return lhs.view() <=> rhs.view();
 }
 
 template <unsigned long N>
@@ -43,13 +87,15 @@ struct member
     typedef T value_type;
     T value_;
     static constexpr auto tag() noexcept {return tag_; }
-    constexpr auto value() const noexcept {return value_; }
+    constexpr T const& value() const& noexcept {return value_; }
+    constexpr T& value() & noexcept {return value_; }
+    constexpr T&& value() && noexcept {return std::move(value_); }
 };//struct member
 
 template< fixed_string tag_, typename T >
-constexpr member<tag_, T> make_member(T value) noexcept
+constexpr member<tag_, std::decay_t<T>> make_member(T&& value) noexcept
 {
-    return member<tag_, T>{value};
+    return member<tag_, std::decay_t<T>>{std::forward<T>(value)};
 }
 
 template< typename T >
@@ -59,395 +105,2179 @@ template< fixed_string tag_, typename T >
 struct is_member< member<tag_, T> > : std::true_type {};
 
 template< typename T >
-constexpr bool is_member_v = is_member<T>::value;
+constexpr bool is_member_v = is_member<std::remove_cvref_t<T>>::value;
 
 template< typename T >
 concept Member = is_member_v<T>;
 
+///
+/// @brief The value of a computed member: `function` applied to the fields `deps_...` of the structure holding it, evaluated on the first read and cached.
+///        The cache is cleared when one of the fields `deps_...` is updated, upgraded, or accessed by `ref`, `set` or `emplace`.
+///        The dependencies are plain fields.
+///        Not thread safe: the cache is filled through a const reference, so two threads reading the same structure before the cache is filled race on it.
+///        Read the computed members once before sharing a structure between threads, or give each thread its own copy. `atomic_struct` does not hold them.
+///
+template< typename R, typename F, fixed_string ... deps_ >
+class computed
+{
+    F function_;
+    mutable std::optional<R> cache_;
+
+    template< fixed_string tag_ >
+    static constexpr bool depends_on_tag() noexcept
+    {
+        return ( ( tag_.view() == deps_.view() ) || ... );
+    }
+
+public:
+    typedef R result_type;
+
+    constexpr explicit computed( F function ) noexcept( std::is_nothrow_move_constructible_v<F> ) : function_( std::move(function) ) {}
+
+    template< fixed_string ... tags_ >
+    static constexpr bool depends_on() noexcept
+    {
+        return ( depends_on_tag<tags_>() || ... );
+    }
+
+    constexpr bool cached() const noexcept { return cache_.has_value(); }
+
+    constexpr void invalidate() const noexcept { cache_.reset(); }
+
+    template< typename S >
+    constexpr R const& get( S const& structure ) const
+    {
+        if ( !cache_ )
+            cache_.emplace( std::invoke( function_, read_struct<deps_>( structure )... ) );
+        return *cache_;
+    }
+};//class computed
+
+template< typename T >
+struct is_computed : std::false_type {};
+
+template< typename R, typename F, fixed_string ... deps_ >
+struct is_computed< computed<R, F, deps_...> > : std::true_type {};
+
+template< typename T >
+constexpr bool is_computed_v = is_computed<std::remove_cvref_t<T>>::value;
+
+namespace detail
+{
+
+// true if `T` is computed from one of the fields `tags_...`
+template< typename T, fixed_string ... tags_ >
+constexpr bool computed_from() noexcept
+{
+    if constexpr ( is_computed_v<T> ) return std::remove_cvref_t<T>::template depends_on<tags_...>();
+    else return false;
+}
+
+}//namespace detail
+
+///
+/// @brief Make a computed member <'tag_', function( fields deps_... )>, read as a value of the result type of `function`.
+///        `function` is not generic, so that its result type is known before it is called.
+/// Example:
+/// \code{.cpp}
+/// auto const s = create_struct( make_member<"name">( std::string{"Meta"} ),
+///                               make_computed_member<"key", "name">( []( std::string const& name ) { return to_lower( name ); } ) );
+/// std::string const& key = s.read<"key">(); // <-- computed here, then cached
+/// \endcode
+///
+template< fixed_string tag_, fixed_string ... deps_, typename F >
+constexpr auto make_computed_member( F&& function ) noexcept( std::is_nothrow_constructible_v<std::decay_t<F>, F&&> )
+{
+    using result_type = std::decay_t<typename decltype( std::function{ function } )::result_type>;
+    return make_member<tag_>( computed<result_type, std::decay_t<F>, deps_...>{ std::forward<F>(function) } );
+}
+
+namespace detail
+{
+
+struct tag_key
+{
+    std::uint64_t hash;
+    std::string_view name;
+};
+
+///
+/// @brief Compile-time perfect-hash table from the tags of a structure to their positions, built by hash and displace:
+///        a tag hashes to a bucket, and the displacement of its bucket moves it to a slot no other tag uses.
+///        `duplicate` is set if two tags are the same, `collision` if two different tags have the same hash.
+///
+template< std::size_t N >
+struct tag_table
+{
+    static constexpr std::size_t buckets = N / 4 + 1;
+    static constexpr std::size_t slots = std::bit_ceil( 2 * N + 1 );
+
+    std::array<tag_key, N> keys{};
+    std::array<std::size_t, buckets> displacements{};
+    std::array<std::size_t, slots> positions{};
+    bool duplicate = false;
+    bool collision = false;
+
+    static constexpr std::size_t bucket_of( std::uint64_t hash ) noexcept
+    {
+        return static_cast<std::size_t>( ( hash >> 40 ) % buckets );
+    }
+
+    // the hash is remixed for every displacement, so two tags of a bucket never share their slot for all the displacements
+    static constexpr std::size_t slot_of( std::uint64_t hash, std::size_t displacement ) noexcept
+    {
+        std::uint64_t x = hash + displacement * 0x9e3779b97f4a7c15ULL;
+        x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+        x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebULL;
+        return static_cast<std::size_t>( ( x ^ ( x >> 31 ) ) & ( slots - 1 ) );
+    }
+
+    ///
+    /// @brief Position of the tag `name` with hash `hash`, or N if there is none. The string is only compared when the hashes match.
+    ///
+    constexpr std::size_t find( std::string_view name, std::uint64_t hash ) const noexcept
+    {
+        std::size_t const position = positions[slot_of( hash, displacements[bucket_of( hash )] )];
+        return ( position < N && keys[position].hash == hash && keys[position].name == name ) ? position : N;
+    }
+};//struct tag_table
+
+template< std::size_t N >
+constexpr tag_table<N> make_tag_table( std::array<tag_key, N> const& keys ) noexcept
+{
+    using table_type = tag_table<N>;
+    table_type ans{};
+    ans.keys = keys;
+    ans.positions.fill( N );
+
+    // keys sorted by bucket, the keys of bucket b are [first[b], first[b+1])
+    std::array<std::size_t, table_type::buckets + 1> first{};
+    for ( tag_key const& key : keys )
+        ++first[table_type::bucket_of( key.hash ) + 1];
+    for ( std::size_t b = 0; b < table_type::buckets; ++b )
+        first[b+1] += first[b];
+    std::array<std::size_t, N> sorted{};
+    std::array<std::size_t, table_type::buckets> filled{};
+    for ( std::size_t index = 0; index < N; ++index )
+    {
+        std::size_t const b = table_type::bucket_of( keys[index].hash );
+        sorted[first[b] + filled[b]++] = index;
+    }
+
+    // identical hashes are in the same bucket: the tags are the same, or collide
+    for ( std::size_t b = 0; b < table_type::buckets; ++b )
+        for ( std::size_t i = first[b]; i < first[b+1]; ++i )
+            for ( std::size_t j = i + 1; j < first[b+1]; ++j )
+                if ( keys[sorted[i]].hash == keys[sorted[j]].hash )
+                    ( keys[sorted[i]].name == keys[sorted[j]].name ? ans.duplicate : ans.collision ) = true;
+    if ( ans.duplicate || ans.collision )
+        return ans;
+
+    // the largest buckets are displaced first, while most of the slots are free
+    std::size_t largest = 0;
+    for ( std::size_t b = 0; b < table_type::buckets; ++b )
+        largest = std::max( largest, first[b+1] - first[b] );
+    for ( std::size_t size = largest; size > 0; --size )
+        for ( std::size_t b = 0; b < table_type::buckets; ++b )
+        {
+            if ( first[b+1] - first[b] != size ) continue;
+            for ( std::size_t displacement = 0; ; ++displacement )
+            {
+                bool free = true;
+                for ( std::size_t i = first[b]; free && i < first[b+1]; ++i )
+                {
+                    std::size_t const slot = table_type::slot_of( keys[sorted[i]].hash, displacement );
+                    free = ans.positions[slot] == N;
+                    for ( std::size_t j = first[b]; free && j < i; ++j )
+                        free = table_type::slot_of( keys[sorted[j]].hash, displacement ) != slot;
+                }
+                if ( !free ) continue;
+                for ( std::size_t i = first[b]; i < first[b+1]; ++i )
+                    ans.positions[table_type::slot_of( keys[sorted[i]].hash, displacement )] = sorted[i];
+                ans.displacements[b] = displacement;
+                break;
+            }
+        }
+    return ans;
+}
+
+///
+/// @brief The perfect-hash table of the tags `tags_...`, keyed by the tags themselves.
+///
+template< fixed_string ... tags_ >
+constexpr auto tag_table_v = make_tag_table<sizeof...(tags_)>( { tag_key{ tags_.hash(), tags_.view() }... } );
+
+///
+/// @brief Position of the first field tagged `tag_` in `Members...`, or `sizeof...(Members)` if there is none.
+///        The position is looked up in the perfect-hash table of the tags, rather than by comparing `tag_` with every tag.
+///
+template< fixed_string tag_, Member ... Members >
+constexpr std::size_t index_of() noexcept
+{
+    return tag_table_v<std::remove_cvref_t<Members>::tag()...>.find( tag_.view(), tag_.hash() );
+}
+
+///
+/// @brief A flat, standard-layout aggregate with up to 8 data members `m0`, ..., `m7`.
+///
+template< typename ... Ms >
+struct block;
+
+template<>
+struct block<> {};
+
+template< typename M0 >
+struct block< M0 > { M0 m0; };
+
+template< typename M0, typename M1 >
+struct block< M0, M1 > { M0 m0; M1 m1; };
+
+template< typename M0, typename M1, typename M2 >
+struct block< M0, M1, M2 > { M0 m0; M1 m1; M2 m2; };
+
+template< typename M0, typename M1, typename M2, typename M3 >
+struct block< M0, M1, M2, M3 > { M0 m0; M1 m1; M2 m2; M3 m3; };
+
+template< typename M0, typename M1, typename M2, typename M3, typename M4 >
+struct block< M0, M1, M2, M3, M4 > { M0 m0; M1 m1; M2 m2; M3 m3; M4 m4; };
+
+template< typename M0, typename M1, typename M2, typename M3, typename M4, typename M5 >
+struct block< M0, M1, M2, M3, M4, M5 > { M0 m0; M1 m1; M2 m2; M3 m3; M4 m4; M5 m5; };
+
+template< typename M0, typename M1, typename M2, typename M3, typename M4, typename M5, typename M6 >
+struct block< M0, M1, M2, M3, M4, M5, M6 > { M0 m0; M1 m1; M2 m2; M3 m3; M4 m4; M5 m5; M6 m6; };
+
+template< typename M0, typename M1, typename M2, typename M3, typename M4, typename M5, typename M6, typename M7 >
+struct block< M0, M1, M2, M3, M4, M5, M6, M7 > { M0 m0; M1 m1; M2 m2; M3 m3; M4 m4; M5 m5; M6 m6; M7 m7; };
+
+template< typename ... Ts >
+struct list {};
+
+///
+/// @brief Group the items by 8: [M0, ..., M19] -> [block<M0, ..., M7>, block<M8, ..., M15>, block<M16, ..., M19>].
+///
+template< typename Done, typename ... Ms >
+struct chunk;
+
+template< typename ... Done, typename ... Ms >
+struct chunk< list<Done...>, Ms... > { typedef list<Done..., block<Ms...>> type; };
+
+template< typename ... Done, typename M0, typename M1, typename M2, typename M3, typename M4, typename M5, typename M6, typename M7, typename M8, typename ... Ms >
+struct chunk< list<Done...>, M0, M1, M2, M3, M4, M5, M6, M7, M8, Ms... > : chunk< list<Done..., block<M0, M1, M2, M3, M4, M5, M6, M7>>, M8, Ms... > {};
+
+///
+/// @brief Blocks of blocks of the items, until at most 8 remain at the root. All the items are at the same depth.
+///
+template< typename L >
+struct tree;
+
+template< typename ... Ms >
+struct tree< list<Ms...> > : tree< typename chunk< list<>, Ms... >::type > {};
+
+template< typename ... Ms >
+requires ( sizeof...(Ms) <= 8 )
+struct tree< list<Ms...> > { typedef block<Ms...> type; };
+
+constexpr std::size_t depth_of( std::size_t size ) noexcept
+{
+    std::size_t depth = 1;
+    for ( std::size_t capacity = 8; capacity < size; capacity *= 8 )
+        ++depth;
+    return depth;
+}
+
+///
+/// @brief Flat, standard-layout aggregate holding the members of a structure in order of creation.
+///        Up to 8 members are stored directly, wider structures nest their members in a tree of blocks of 8.
+///        The storage is trivially copyable whenever all the members are.
+///
+template< typename ... Ms >
+struct storage : tree< list<Ms...> >::type
+{
+    static_assert( depth_of( sizeof...(Ms) ) <= 4, "At most 4096 fields are supported." );
+};
+
+template< typename S >
+struct storage_size;
+
+template< typename ... Ms >
+struct storage_size< storage<Ms...> > : std::integral_constant<std::size_t, sizeof...(Ms)> {};
+
+template< typename S >
+constexpr std::size_t storage_size_v = storage_size<std::remove_cvref_t<S>>::value;
+
+///
+/// @brief Pointer to the data member `m{D}` of a block.
+///
+template< typename Block, std::size_t D >
+constexpr auto child = []() noexcept
+{
+    if constexpr ( D == 0 ) return &Block::m0;
+    else if constexpr ( D == 1 ) return &Block::m1;
+    else if constexpr ( D == 2 ) return &Block::m2;
+    else if constexpr ( D == 3 ) return &Block::m3;
+    else if constexpr ( D == 4 ) return &Block::m4;
+    else if constexpr ( D == 5 ) return &Block::m5;
+    else if constexpr ( D == 6 ) return &Block::m6;
+    else return &Block::m7;
+}();
+
+template< typename P >
+struct pointee;
+
+template< typename C, typename T >
+struct pointee< T C::* > { typedef T type; };
+
+template< typename Block, std::size_t D >
+using child_t = typename pointee<std::remove_const_t<decltype(child<Block, D>)>>::type;
+
+template< typename S >
+struct root;
+
+template< typename ... Ms >
+struct root< storage<Ms...> > : tree< list<Ms...> > {};
+
+template< typename St >
+using root_t = typename root<std::remove_cvref_t<St>>::type;
+
+///
+/// @brief Access the I-th member in a storage, keeping the value category of the storage.
+///
+template< std::size_t I, typename St >
+constexpr decltype(auto) get( St&& st ) noexcept
+{
+    using T = root_t<St>;
+    constexpr std::size_t depth = depth_of( storage_size_v<St> );
+    if constexpr ( depth == 1 )
+        return ( std::forward<St>(st).*child<T, I> );
+    else if constexpr ( depth == 2 )
+        return ( ( std::forward<St>(st).*child<T, I/8> ).*child<child_t<T, I/8>, I%8> );
+    else if constexpr ( depth == 3 )
+        return ( ( ( std::forward<St>(st).*child<T, I/64> ).*child<child_t<T, I/64>, I/8%8> ).*child<child_t<child_t<T, I/64>, I/8%8>, I%8> );
+    else
+        return ( ( ( ( std::forward<St>(st).*child<T, I/512> ).*child<child_t<T, I/512>, I/64%8> ).*child<child_t<child_t<T, I/512>, I/64%8>, I/8%8> ).*child<child_t<child_t<child_t<T, I/512>, I/64%8>, I/8%8>, I%8> );
+}
+
+// the nested blocks are initialized by brace elision, so the initializers are evaluated in order and without recursion
+template< typename ... As >
+constexpr auto make_storage( As&& ... as ) noexcept
+{
+    return storage<std::remove_cvref_t<As>...>{ std::forward<As>(as)... };
+}
+
+// a member `M` of a storage `St`, as `st.*child` reaches it: with the constness and the value category of the storage
+template< typename St, typename M >
+using member_ref_t = std::conditional_t<std::is_lvalue_reference_v<St>,
+                                        std::conditional_t<std::is_const_v<std::remove_reference_t<St>>, M const&, M&>,
+                                        std::conditional_t<std::is_const_v<std::remove_reference_t<St>>, M const&&, M&&>>;
+
+// true if `apply( st, function )` cannot throw: `function` does not throw when called with the members of `St`
+template< typename F, typename St, typename S = std::remove_cvref_t<St> >
+constexpr bool is_nothrow_applicable_v = false;
+
+template< typename F, typename St, typename ... Ms >
+constexpr bool is_nothrow_applicable( storage<Ms...> const* ) noexcept
+{
+    if constexpr ( sizeof...(Ms) == 0 ) return !std::is_invocable_v<F> || std::is_nothrow_invocable_v<F>;
+    else return std::is_nothrow_invocable_v<F, member_ref_t<St, Ms>...>;
+}
+
+template< typename F, typename St, typename ... Ms >
+constexpr bool is_nothrow_applicable_v< F, St, storage<Ms...> > = is_nothrow_applicable<F, St>( static_cast<storage<Ms...> const*>( nullptr ) );
+
+///
+/// @brief Call `function` with all the members in a storage. An empty storage only calls `function` if it accepts an empty argument list.
+///        The members are reached through pointers to data members, as `get<I>` would, but in a single function: no function is instantiated per member.
+///
+template< typename St, typename F >
+constexpr decltype(auto) apply( St&& st, F&& function ) noexcept( is_nothrow_applicable_v<F, St> )
+{
+    using T = root_t<St>;
+    constexpr std::size_t depth = depth_of( storage_size_v<St> );
+    return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept( is_nothrow_applicable_v<F, St> ) -> decltype(auto)
+    {
+        if constexpr ( sizeof...(Is) == 0 )
+        {
+            if constexpr ( std::is_invocable_v<F> )
+                return std::forward<F>(function)();
+        }
+        else if constexpr ( depth == 1 )
+            return std::forward<F>(function)( std::forward<St>(st).*child<T, Is>... );
+        else if constexpr ( depth == 2 )
+            return std::forward<F>(function)( ( std::forward<St>(st).*child<T, Is/8> ).*child<child_t<T, Is/8>, Is%8>... );
+        else if constexpr ( depth == 3 )
+            return std::forward<F>(function)( ( ( std::forward<St>(st).*child<T, Is/64> ).*child<child_t<T, Is/64>, Is/8%8> ).*child<child_t<child_t<T, Is/64>, Is/8%8>, Is%8>... );
+        else
+            return std::forward<F>(function)( ( ( ( std::forward<St>(st).*child<T, Is/512> ).*child<child_t<T, Is/512>, Is/64%8> ).*child<child_t<child_t<T, Is/512>, Is/64%8>, Is/8%8> ).*child<child_t<child_t<child_t<T, Is/512>, Is/64%8>, Is/8%8>, Is%8>... );
+    }( std::make_index_sequence<storage_size_v<St>>{} );
+}
+
+template< std::size_t I, typename T >
+struct indexed
+{
+    T&& value;
+};
+
+///
+/// @brief References to the arguments of a parameter pack, each one reachable by its position with `at<I>`.
+///        `at<I>` only names the I-th type, so indexing into a wide pack does not instantiate functions over the whole pack.
+///
+template< typename Is, typename ... Ts >
+struct pack;
+
+template< std::size_t ... Is, typename ... Ts >
+struct pack< std::index_sequence<Is...>, Ts... > : indexed<Is, Ts>... {};
+
+template< typename ... Ts >
+constexpr auto make_pack( Ts&& ... ts ) noexcept
+{
+    return pack<std::index_sequence_for<Ts...>, Ts...>{ {std::forward<Ts>(ts)}... };
+}
+
+template< std::size_t I, typename T >
+constexpr T&& at( indexed<I, T> const& element ) noexcept
+{
+    return std::forward<T>( element.value );
+}
+
+template< std::size_t I, typename ... Ts >
+using type_at = std::remove_cvref_t<decltype( at<I>( std::declval<pack<std::index_sequence_for<Ts...>, Ts...>&>() ) )>;
+
+///
+/// @brief Call `function` with all the members of all the structures, the recursion is over the number of structures only. An exception thrown by `function` propagates.
+///
+template< typename F, typename S, typename ... SS >
+constexpr decltype(auto) apply_all( F&& function, S&& s, SS&& ... ss )
+{
+    return std::forward<S>(s)( [&]<typename ... MS>( MS&& ... members ) -> decltype(auto)
+    {
+        if constexpr ( sizeof...(SS) == 0 )
+            return std::forward<F>(function)( std::forward<MS>(members)... );
+        else
+            return apply_all( [&]<typename ... MT>( MT&& ... rest ) -> decltype(auto) { return std::forward<F>(function)( std::forward<MS>(members)..., std::forward<MT>(rest)... ); }, std::forward<SS>(ss)... );
+    } );
+}
+
+///
+/// @brief `member`, or a copy of it with an empty cache if it is computed from one of the fields `tags_...`.
+///
+template< fixed_string ... tags_, typename M >
+constexpr decltype(auto) keep_member( M&& member ) noexcept
+{
+    using value_type = typename std::remove_cvref_t<M>::value_type;
+    if constexpr ( computed_from<value_type, tags_...>() )
+    {
+        std::remove_cvref_t<M> ans{ std::forward<M>(member) };
+        ans.value().invalidate();
+        return ans;
+    }
+    else return std::forward<M>(member);
+}
+
+///
+/// @brief Clear the caches of the members of `s` computed from one of the fields `tags_...`.
+///
+template< fixed_string ... tags_, typename S >
+constexpr void invalidate_dependents( S const& s ) noexcept
+{
+    s( [&]<typename ... MS>( MS const& ... members ) noexcept
+    {
+        ( [&]<typename M>( M const& member ) noexcept
+        {
+            if constexpr ( computed_from<typename M::value_type, tags_...>() )
+                member.value().invalidate();
+        }( members ), ... );
+    } );
+}
+
+///
+/// @brief `member`, or a new member <'tag_', value> if `replace_` is set.
+///
+template< bool replace_, fixed_string tag_, typename M, typename T >
+constexpr decltype(auto) replace_if( M&& member, T&& value ) noexcept
+{
+    if constexpr ( replace_ ) return make_member<tag_>( std::forward<T>(value) );
+    else return keep_member<tag_>( std::forward<M>(member) );
+}
+
+///
+/// @brief `member`, or `member` upgraded with `value` if `upgrade_` is set.
+///
+template< bool upgrade_, fixed_string tag_, typename M, typename T >
+constexpr decltype(auto) upgrade_if( M&& member, T&& value ) noexcept
+{
+    if constexpr ( !upgrade_ ) return keep_member<tag_>( std::forward<M>(member) );
+    else if constexpr ( std::is_same_v<std::decay_t<T>, typename std::remove_cvref_t<M>::value_type> ) return make_member<tag_>( std::forward<T>(value) );
+    else return make_member<tag_>( overload( std::forward<T>(value), std::forward<M>(member).value() ) );
+}
+
+///
+/// @brief Positions [0, N) without position K.
+///
+template< std::size_t N, std::size_t K >
+constexpr std::array<std::size_t, N-1> indices_without() noexcept
+{
+    std::array<std::size_t, N-1> ans{};
+    for ( std::size_t index = 0; index < N-1; ++index )
+        ans[index] = index < K ? index : index + 1;
+    return ans;
+}
+
+///
+/// @brief The first `N` positions marked in `marks`, in order.
+///
+template< std::size_t N, std::size_t M >
+constexpr std::array<std::size_t, N> marked_indices( std::array<bool, M> const& marks ) noexcept
+{
+    std::array<std::size_t, N> ans{};
+    std::size_t count = 0;
+    for ( std::size_t index = 0; index < M && count < N; ++index )
+        if ( marks[index] )
+            ans[count++] = index;
+    return ans;
+}
+
+///
+/// @brief `member`, or the update at position `U` of `updates` if there is one.
+///
+template< std::size_t U, fixed_string ... tags_, typename M, typename P >
+constexpr decltype(auto) update_at( M&& member, P const& updates ) noexcept
+{
+    if constexpr ( requires { at<U>( updates ); } ) return at<U>( updates );
+    else return keep_member<tags_...>( std::forward<M>(member) );
+}
+
+template< fixed_string tag_ >
+struct tag_of
+{
+    static constexpr auto value = tag_;
+};
+
+template< fixed_string tag_, typename S >
+struct index_of_tag;
+
+template< fixed_string tag_, typename ... Ms >
+struct index_of_tag< tag_, storage<Ms...> > : std::integral_constant<std::size_t, index_of<tag_, Ms...>()> {};
+
+template< typename S >
+struct table_of;
+
+template< typename ... Ms >
+struct table_of< storage<Ms...> >
+{
+    static constexpr auto const& value = tag_table_v<Ms::tag()...>;
+};
+
+///
+/// @brief Position of the field named `name` in a storage, or the number of fields if there is none: one hash, then one lookup in the perfect-hash table.
+///
+template< typename S >
+constexpr std::size_t index_of_name( std::string_view name ) noexcept
+{
+    return table_of<S>::value.find( name, fnv1a( name ) );
+}
+
+template< typename S >
+struct lazy_fields_of;
+
+}//namespace detail
+
+template< typename Source, typename Fields, typename ... Ts >
+class lazy_struct;
+
 template< typename S >
 struct structure
 {
     S s_;
 
+    // members are passed to `function` as const lvalues, or as rvalues when the structure itself is an rvalue; an exception thrown by `function` propagates
+    template< typename F >
+    constexpr decltype(auto) operator()(F && function) const& noexcept( detail::is_nothrow_applicable_v<F, S const&> ) { return detail::apply( s_, std::forward<F>(function) ); }
+
     template< typename F >
-    constexpr auto operator()(F && function) const noexcept { return s_( std::forward<F>(function) ); }
+    constexpr decltype(auto) operator()(F && function) && noexcept( detail::is_nothrow_applicable_v<F, S> ) { return detail::apply( std::move(s_), std::forward<F>(function) ); }
+
+    static constexpr std::size_t size() noexcept { return detail::storage_size_v<S>; }
 
     //
     // read, retrieve, get, browse, view
     //
 
-    template< fixed_string tag_>
-    constexpr auto read() const noexcept
+    template< fixed_string tag_>
+    constexpr decltype(auto) read() const noexcept
+    {
+        return read_struct<tag_>( *this );
+    }
+
+    template< fixed_string tag_>
+    constexpr decltype(auto) ref() const& noexcept
+    {
+        return read_struct<tag_>( *this );
+    }
+
+    //
+    // mutable access: ref, set, emplace. The fields keep their types, `update` is still needed to change one
+    //
+
+    template< fixed_string tag_>
+    constexpr auto& ref() & noexcept
+    {
+        constexpr std::size_t index = detail::index_of_tag<tag_, S>::value;
+        static_assert( index < size(), "This field is not defined in the structure." );
+        detail::invalidate_dependents<tag_>( *this );
+        return detail::get<index>( s_ ).value_;
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr structure& set( T&& value ) & noexcept( noexcept( std::declval<structure&>().template ref<tag_>() = std::declval<T>() ) )
+    {
+        static_assert( std::is_assignable_v<decltype(ref<tag_>()), T&&>, "set assigns in place, the value cannot change the type of the field: use update instead." );
+        ref<tag_>() = std::forward<T>(value);
+        return *this;
+    }
+
+    template< fixed_string tag_, typename ... Args >
+    constexpr structure& emplace( Args&& ... args ) &
+    {
+        auto& field = ref<tag_>();
+        using value_type = std::remove_reference_t<decltype(field)>;
+        static_assert( std::is_constructible_v<value_type, Args&&...>, "emplace constructs the field in place, from arguments its type is constructible from." );
+        // the field is destroyed first only if constructing it cannot throw, otherwise a temporary is assigned
+        if constexpr ( std::is_nothrow_constructible_v<value_type, Args&&...> )
+        {
+            std::destroy_at( std::addressof( field ) );
+            std::construct_at( std::addressof( field ), std::forward<Args>(args)... );
+        }
+        else
+            field = value_type( std::forward<Args>(args)... );
+        return *this;
+    }
+
+    template< fixed_string tag_>
+    constexpr decltype(auto) retrieve() const noexcept
+    {
+        return read<tag_>();
+    }
+
+    template< fixed_string tag_>
+    constexpr decltype(auto) get() const noexcept
+    {
+        return read<tag_>();
+    }
+
+    template< fixed_string tag_>
+    constexpr decltype(auto) browse() const noexcept
+    {
+        return read<tag_>();
+    }
+
+    template< fixed_string tag_>
+    constexpr decltype(auto) view() const noexcept
+    {
+        return read<tag_>();
+    }
+
+    //
+    // update, put, change, edit
+    //
+
+    template< fixed_string tag_, typename T >
+    constexpr auto update( T&& value ) const& noexcept
+    {
+        return update_struct<tag_>( *this, std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto update( T&& value ) && noexcept
+    {
+        return update_struct<tag_>( std::move(*this), std::forward<T>(value) );
+    }
+
+    // with an allocator, see meta_pmr.hpp
+    template< fixed_string tag_, typename Allocator, typename T >
+    auto update( std::allocator_arg_t, Allocator const& allocator, T&& value ) const&
+    {
+        return update_struct<tag_>( std::allocator_arg, allocator, *this, std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename Allocator, typename T >
+    auto update( std::allocator_arg_t, Allocator const& allocator, T&& value ) &&
+    {
+        return update_struct<tag_>( std::allocator_arg, allocator, std::move(*this), std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto put( T&& value ) const& noexcept
+    {
+        return update<tag_>( std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto put( T&& value ) && noexcept
+    {
+        return std::move(*this).template update<tag_>( std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto change( T&& value ) const& noexcept
+    {
+        return update<tag_>( std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto change( T&& value ) && noexcept
+    {
+        return std::move(*this).template update<tag_>( std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto edit( T&& value ) const& noexcept
+    {
+        return update<tag_>( std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto edit( T&& value ) && noexcept
+    {
+        return std::move(*this).template update<tag_>( std::forward<T>(value) );
+    }
+
+
+    //
+    // (delete), destroy, remove, erase
+    //
+
+    template< fixed_string tag_ >
+    constexpr auto destroy() const& noexcept
+    {
+        return delete_struct<tag_>( *this );
+    }
+
+    template< fixed_string tag_ >
+    constexpr auto destroy() && noexcept
+    {
+        return delete_struct<tag_>( std::move(*this) );
+    }
+
+    template< fixed_string tag_, typename Allocator >
+    auto destroy( std::allocator_arg_t, Allocator const& allocator ) const&
+    {
+        return delete_struct<tag_>( std::allocator_arg, allocator, *this );
+    }
+
+    template< fixed_string tag_, typename Allocator >
+    auto destroy( std::allocator_arg_t, Allocator const& allocator ) &&
+    {
+        return delete_struct<tag_>( std::allocator_arg, allocator, std::move(*this) );
+    }
+
+    template< fixed_string tag_ >
+    constexpr auto remove() const& noexcept
+    {
+        return destroy<tag_>();
+    }
+
+    template< fixed_string tag_ >
+    constexpr auto remove() && noexcept
+    {
+        return std::move(*this).template destroy<tag_>();
+    }
+
+    template< fixed_string tag_ >
+    constexpr auto erase() const& noexcept
+    {
+        return destroy<tag_>();
+    }
+
+    template< fixed_string tag_ >
+    constexpr auto erase() && noexcept
+    {
+        return std::move(*this).template destroy<tag_>();
+    }
+
+
+    //
+    // map, for_each
+    //
+
+    template<typename F >
+    constexpr auto map( F&& function )
+    {
+        return map_struct( *this, function );
+    }
+
+    template<typename F >
+    constexpr auto for_each( F&& function )
+    {
+        return map( function );
+    }
+
+    // visits the fields without building a structure
+    template<typename F >
+    constexpr void for_each_field( F&& function ) const
+    {
+        (*this)( [&]<Member ... MS>( MS const& ... members ) { ( function( members ), ... ); } );
+    }
+
+    template< typename T, typename F >
+    constexpr auto fold( T&& init, F&& function ) const
+    {
+        return fold_struct( *this, std::forward<T>(init), std::forward<F>(function) );
+    }
+
+
+    //
+    // add, append, insert
+    //
+    template< fixed_string tag_, typename T >
+    constexpr auto add( T&& value ) const& noexcept
+    {
+        return cons( *this, create_struct( make_member<tag_>( std::forward<T>(value) ) ) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto add( T&& value ) && noexcept
+    {
+        return cons( std::move(*this), create_struct( make_member<tag_>( std::forward<T>(value) ) ) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto append( T&& value ) const& noexcept
+    {
+        return add<tag_>( std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto append( T&& value ) && noexcept
+    {
+        return std::move(*this).template add<tag_>( std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto insert( T&& value ) const& noexcept
+    {
+        return add<tag_>( std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto insert( T&& value ) && noexcept
+    {
+        return std::move(*this).template add<tag_>( std::forward<T>(value) );
+    }
+
+    //
+    // has, contains
+    //
+
+    template< fixed_string tag_ >
+    constexpr bool has()  const noexcept
+    {
+        return struct_has<tag_>( *this );
+    }
+
+    template< fixed_string tag_ >
+    constexpr bool contain()  const noexcept
+    {
+        return has<tag_>();
+    }
+
+    constexpr bool has( std::string_view name ) const noexcept
+    {
+        return struct_has( *this, name );
+    }
+
+    constexpr bool contain( std::string_view name ) const noexcept
+    {
+        return has( name );
+    }
+
+    //
+    // visit, a field named at runtime
+    //
+
+    template< typename V >
+    constexpr bool visit( std::string_view name, V&& visitor ) const
+    {
+        return visit_field( *this, name, std::forward<V>(visitor) );
+    }
+
+    //
+    // upgrade. Note: this is different from update
+    //
+
+    template< fixed_string tag_, typename T >
+    constexpr auto upgrade( T&& value ) const& noexcept
+    {
+        return upgrade_struct<tag_>( *this, std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename T >
+    constexpr auto upgrade( T&& value ) && noexcept
+    {
+        return upgrade_struct<tag_>( std::move(*this), std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename Allocator, typename T >
+    auto upgrade( std::allocator_arg_t, Allocator const& allocator, T&& value ) const&
+    {
+        return upgrade_struct<tag_>( std::allocator_arg, allocator, *this, std::forward<T>(value) );
+    }
+
+    template< fixed_string tag_, typename Allocator, typename T >
+    auto upgrade( std::allocator_arg_t, Allocator const& allocator, T&& value ) &&
+    {
+        return upgrade_struct<tag_>( std::allocator_arg, allocator, std::move(*this), std::forward<T>(value) );
+    }
+
+    //
+    // lazy, defer a chain of CRUD operations until the result is needed
+    //
+
+    constexpr auto lazy() const& noexcept
+    {
+        return lazy_struct<structure const&, typename detail::lazy_fields_of<S>::type>{ *this, {} };
+    }
+
+    constexpr auto lazy() && noexcept
+    {
+        return lazy_struct<structure, typename detail::lazy_fields_of<S>::type>{ std::move(*this), {} };
+    }
+
+    //
+    // packed, reorder the fields to minimize padding
+    //
+
+    constexpr auto packed() const& noexcept
+    {
+        return pack_struct( *this );
+    }
+
+    constexpr auto packed() && noexcept
+    {
+        return pack_struct( std::move(*this) );
+    }
+
+};//struct structure
+
+template< typename T >
+struct is_structure : std::false_type {};
+
+template< typename T >
+struct is_structure< structure<T> > : std::true_type {};
+
+template< typename T >
+constexpr bool is_structure_v = is_structure<std::remove_cvref_t<T>>::value;
+
+template< typename T >
+concept Structure = is_structure_v<T>;
+
+template< Member ... Members >
+using structure_type = structure<detail::storage<Members...>>;
+
+///
+/// @brief CREATE a meta structure with one or more members (fields). The tags must be unique, a duplicate tag is a compilation error.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto m1 = make_member<"one">(1);
+/// constexpr auto m2 = make_member<"two">(2UL);
+/// constexpr auto m3 = make_member<"three">(2.0f);
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// \endcode
+///
+template< Member ... Members >
+constexpr auto create_struct(Members&& ... members) noexcept
+{
+    constexpr auto table = detail::tag_table_v<std::remove_cvref_t<Members>::tag()...>;
+    static_assert( !table.duplicate, "A tag is used by more than one field of the structure." );
+    static_assert( !table.collision, "Two different tags of the structure have the same hash, please rename one of them." );
+    return structure{ detail::make_storage( std::forward<Members>(members)... ) };
+}
+
+template< Member ... Members >
+constexpr auto make_struct(Members&& ... members) noexcept
+{
+    return create_struct( std::forward<Members>(members)... );
+}
+
+///
+/// @brief concatenate_struct two or more meta structures.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s1 = create_struct( m1, m2 );
+/// constexpr auto s2 = create_struct( m3 );
+/// constexpr auto s3 = concatenate_struct( s1, s2 );
+/// constexpr auto s4 = concatenate_struct( s1, s2, s3 );
+/// \endcode
+///
+template< Structure ... SS >
+constexpr auto concatenate_struct( SS&& ... ss ) noexcept
+{
+    return detail::apply_all( [&]<Member ... MS>( MS&& ... members ) noexcept { return create_struct( std::forward<MS>(members)... ); }, std::forward<SS>(ss)... );
+}
+
+template< typename ... TS >
+constexpr auto cons( TS&& ... ts ) noexcept
+{
+    return concatenate_struct( std::forward<TS>(ts)... );
+}
+
+
+
+///
+/// @brief READ a field from a meta structure. If not find this filed, will trigger a compilation error.
+///        The position of the field is resolved at compile time, and a const reference to the stored value is returned.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// constexpr auto v = read_struct<"one">( s );
+/// \endcode
+///
+template< fixed_string tag_, Structure S >
+constexpr decltype(auto) read_struct( S const& structure ) noexcept
+{
+    constexpr std::size_t index = detail::index_of_tag<tag_, decltype(structure.s_)>::value;
+    static_assert( index < S::size(), "This field is not defined in the structure." );
+    if constexpr ( is_computed_v<decltype(detail::get<index>( structure.s_ ).value())> )
+        return detail::get<index>( structure.s_ ).value().get( structure );
+    else
+        return detail::get<index>( structure.s_ ).value();
+}
+
+///
+/// @brief UPDATE a field in a meta structure. If not find this filed, a new field <'tag_', value> will be appended.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// constexpr auto t = update_struct<"one">( s, 1.0f );
+/// \endcode
+///
+template< fixed_string tag_, Structure S, typename T >
+constexpr auto update_struct( S&& structure, T&& value ) noexcept
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
+    {
+        constexpr std::size_t index = detail::index_of<tag_, std::remove_cvref_t<MS>...>();
+        if constexpr ( index < sizeof...(MS) )
+            return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+            {
+                return create_struct( detail::replace_if<Is == index, tag_>( std::forward<MS>(members), std::forward<T>(value) )...  );
+            }( std::index_sequence_for<MS...>{} );
+        else
+            return create_struct( std::forward<MS>(members)..., make_member<tag_>( std::forward<T>(value) ) );
+    } );
+}
+
+///
+/// @brief DELETE a field in a meta structure. If not find this filed, return the original structure.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// constexpr auto t = delete_struct<"one">( s );
+/// \endcode
+///
+template< fixed_string tag_, Structure S >
+constexpr auto delete_struct( S&& structure ) noexcept
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
+    {
+        constexpr std::size_t index = detail::index_of<tag_, std::remove_cvref_t<MS>...>();
+        if constexpr ( index == sizeof...(MS) )
+            return create_struct( std::forward<MS>(members)... );
+        else
+        {
+            constexpr auto kept = detail::indices_without<sizeof...(MS), index>();
+            auto const pack = detail::make_pack( std::forward<MS>(members)... );
+            return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+            {
+                return create_struct( detail::at<kept[Is]>( pack )... );
+            }( std::make_index_sequence<sizeof...(MS)-1>{} );
+        }
+    } );
+}
+
+///
+/// @brief UPDATE several fields of a meta structure in one pass: every field is constructed once, from its update or from the original field.
+///        As with `update_struct`, the updates of fields not in the structure are appended, in order. A tag may be updated only once.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// constexpr auto t = update_fields( s, make_member<"one">( 1.0f ), make_member<"four">( 4 ) );
+/// \endcode
+///
+template< Structure S, Member ... Us >
+constexpr auto update_fields( S&& structure, Us&& ... updates ) noexcept
+{
+    static_assert( !detail::tag_table_v<std::remove_cvref_t<Us>::tag()...>.duplicate, "A tag is updated more than once." );
+    auto const pack = detail::make_pack( std::forward<Us>(updates)... );
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
+    {
+        constexpr std::array<bool, sizeof...(Us)> missing{ { ( detail::index_of<std::remove_cvref_t<Us>::tag(), std::remove_cvref_t<MS>...>() == sizeof...(MS) )... } };
+        constexpr std::size_t appended = std::count( missing.begin(), missing.end(), true );
+        constexpr auto positions = detail::marked_indices<appended>( missing );
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+        {
+            return create_struct( detail::update_at<detail::index_of<std::remove_cvref_t<MS>::tag(), std::remove_cvref_t<Us>...>(), std::remove_cvref_t<Us>::tag()...>( std::forward<MS>(members), pack )...,
+                                  detail::at<positions[Is]>( pack )... );
+        }( std::make_index_sequence<appended>{} );
+    } );
+}
+
+///
+/// @brief DELETE several fields of a meta structure in one pass, every remaining field is constructed once. The tags not in the structure are ignored.
+///        A tag may be deleted only once: `delete_fields<"one", "one">( s )` is a compilation error.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// constexpr auto t = delete_fields<"one", "three">( s );
+/// \endcode
+///
+template< fixed_string ... tags_, Structure S >
+constexpr auto delete_fields( S&& structure ) noexcept
+{
+    // the tags are looked up in their own perfect-hash table, which is not built if two of them are the same or have the same hash
+    static_assert( !detail::tag_table_v<tags_...>.duplicate, "A tag is deleted more than once." );
+    static_assert( !detail::tag_table_v<tags_...>.collision, "Two different tags to delete have the same hash, please delete them in two calls." );
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
+    {
+        constexpr std::array<bool, sizeof...(MS)> kept{ { ( detail::tag_table_v<tags_...>.find( detail::tag_of<std::remove_cvref_t<MS>::tag()>::value.view(), std::remove_cvref_t<MS>::tag().hash() ) == sizeof...(tags_) )... } };
+        constexpr std::size_t size = std::count( kept.begin(), kept.end(), true );
+        constexpr auto positions = detail::marked_indices<size>( kept );
+        auto const pack = detail::make_pack( std::forward<MS>(members)... );
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+        {
+            return create_struct( detail::at<positions[Is]>( pack )... );
+        }( std::make_index_sequence<size>{} );
+    } );
+}
+
+///
+/// @breif MAP a function to each field in the meta structure.
+/// EXAMPLE:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// constexpr auto t = map_struct( s, []<Member M>(M const& member) { std::cout << static_cast<std::string>(M::tag()) << ": " << member.value() << std::endl; return member.value(); } );
+/// \endcode
+///
+template< Structure S, typename F >
+constexpr auto map_struct( S&& structure, F && function ) noexcept
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
+    {
+        // the braced initialization applies `function` to the fields in order
+        using result_type = structure_type<member<std::remove_cvref_t<MS>::tag(), std::decay_t<std::invoke_result_t<F&, MS&&>>>...>;
+        return result_type{ { member<std::remove_cvref_t<MS>::tag(), std::decay_t<std::invoke_result_t<F&, MS&&>>>{ function( std::forward<MS>(members) ) }... } };
+    } );
+}
+
+///
+/// @brief VISIT every field of a meta structure in order, without building a structure nor copying the fields.
+///        The members are passed as const lvalues, or as rvalues if the structure is an rvalue.
+/// EXAMPLE:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// for_each_field( s, []<Member M>( M const& member ) { std::cout << static_cast<std::string>(M::tag()) << ": " << member.value() << std::endl; } );
+/// \endcode
+///
+template< Structure S, typename F >
+constexpr void for_each_field( S&& structure, F&& function )
+{
+    std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members )
+    {
+        ( function( std::forward<MS>(members) ), ... );
+    } );
+}
+
+///
+/// @brief FOLD the fields of a meta structure from the left: `function( function( init, m0 ), m1 )...`, without building a structure nor copying the fields.
+///        The accumulator keeps the type of `init`.
+/// EXAMPLE:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( make_member<"a">( 1 ), make_member<"b">( 2.5 ) );
+/// constexpr double sum = fold_struct( s, 0.0, []<Member M>( double acc, M const& member ) { return acc + member.value(); } );
+/// \endcode
+///
+template< Structure S, typename T, typename F >
+constexpr std::decay_t<T> fold_struct( S&& structure, T&& init, F&& function )
+{
+    std::decay_t<T> acc( std::forward<T>(init) );
+    std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members )
+    {
+        ( ( acc = function( std::move(acc), std::forward<MS>(members) ) ), ... );
+    } );
+    return acc;
+}
+
+///
+/// @brief FILTER the fields of a meta structure by their value types: the result keeps, in order, the fields for which `Pred<value_type>::value` holds.
+///        The kept fields are constructed once, and moved if the structure is an rvalue.
+/// EXAMPLE:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( make_member<"a">( 1 ), make_member<"b">( 'b' ), make_member<"c">( 2.5 ) );
+/// constexpr auto t = filter_struct<std::is_floating_point>( s ); // <-- only "c"
+/// \endcode
+///
+template< template< typename > class Pred, Structure S >
+constexpr auto filter_struct( S&& structure ) noexcept
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
+    {
+        constexpr std::array<bool, sizeof...(MS)> kept{ { bool( Pred<typename std::remove_cvref_t<MS>::value_type>::value )... } };
+        constexpr std::size_t size = std::count( kept.begin(), kept.end(), true );
+        constexpr auto positions = detail::marked_indices<size>( kept );
+        auto const pack = detail::make_pack( std::forward<MS>(members)... );
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+        {
+            return create_struct( detail::at<positions[Is]>( pack )... );
+        }( std::make_index_sequence<size>{} );
+    } );
+}
+
+namespace detail
+{
+
+template< template< typename > class Pred, typename F, Member M >
+constexpr decltype(auto) transform_member( F& function, M&& m ) noexcept
+{
+    using member_type = std::remove_cvref_t<M>;
+    if constexpr ( Pred<typename member_type::value_type>::value )
+        return member<member_type::tag(), std::decay_t<std::invoke_result_t<F&, M&&>>>{ function( std::forward<M>(m) ) };
+    else
+        return std::forward<M>(m);
+}
+
+}//namespace detail
+
+///
+/// @brief TRANSFORM the fields of a meta structure whose value types satisfy `Pred`, as `map_struct` would, and keep the other fields as they are.
+/// EXAMPLE:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( make_member<"a">( 1 ), make_member<"b">( 'b' ), make_member<"c">( 2.5 ) );
+/// constexpr auto t = transform_if<std::is_floating_point>( s, []<Member M>( M const& member ) { return member.value() * 2; } ); // <-- "c" is 5.0
+/// \endcode
+///
+template< template< typename > class Pred, Structure S, typename F >
+constexpr auto transform_if( S&& structure, F&& function ) noexcept
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
+    {
+        // the braced initialization transforms the fields in order
+        using result_type = structure_type<std::remove_cvref_t<decltype( detail::transform_member<Pred>( function, std::forward<MS>(members) ) )>...>;
+        return result_type{ { detail::transform_member<Pred>( function, std::forward<MS>(members) )... } };
+    } );
+}
+
+///
+/// @breif CHECK if a field in the meta structure.
+/// EXAMPLE:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// constexpr bool has_a = struct_has<"a">( s );
+/// constexpr bool has_b = struct_has<"b">( s );
+/// \endcode
+///
+template< fixed_string tag_, Structure S >
+constexpr bool struct_has( S const& ) noexcept
+{
+    return detail::index_of_tag<tag_, decltype(std::declval<S const&>().s_)>::value < S::size();
+}
+
+///
+/// @breif CHECK if a field named `name`, only known at runtime, is in the meta structure.
+/// EXAMPLE:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// bool const has_field = struct_has( s, query.field_name );
+/// \endcode
+///
+template< Structure S >
+constexpr bool struct_has( S const&, std::string_view name ) noexcept
+{
+    return detail::index_of_name<decltype(std::declval<S const&>().s_)>( name ) < S::size();
+}
+
+///
+/// @brief VISIT the field named `name`, only known at runtime: `visitor` is called with the member, as `map_struct` would.
+///        The field is found with one hash and one comparison, and `visitor` is dispatched through a jump table.
+///        Returns false, without calling `visitor`, if there is no such field.
+/// EXAMPLE:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// visit_field( s, "two", []<Member M>( M const& member ) { std::cout << member.value() << std::endl; } );
+/// \endcode
+///
+template< Structure S, typename V >
+constexpr bool visit_field( S const& structure, std::string_view name, V&& visitor )
+{
+    using storage_type = decltype(structure.s_);
+    using function_type = void (*)( storage_type const&, V& );
+    constexpr auto jump = []<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+    {
+        return std::array<function_type, sizeof...(Is)>{ { []( storage_type const& st, V& function ) { function( detail::get<Is>( st ) ); }... } };
+    }( std::make_index_sequence<S::size()>{} );
+
+    std::size_t const index = detail::index_of_name<storage_type>( name );
+    if ( index == S::size() )
+        return false;
+    jump[index]( structure.s_, visitor );
+    return true;
+}
+
+
+///
+/// @brief UPGRADE a field in a meta structure, to make this field hold more data.
+///        If not find this filed, a new field <'tag_', value> will be appended.
+///        If find this filed,
+///           if value type is identical, the old value will be replaced,
+///           otherwise, the old value will co-exist with the new one by an `overloaded` object.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( make_member<"f">( []( int i ){ std::cout << "f: got int " << i << std::endl;} );
+/// constexpr auto t = upgrade_struct<"f">( s, []( double d ){ std::cout << "f: got double " << d << std::endl; } );
+/// read_struct<"f">( 1 ); // <-- will produce f: got int 1
+/// read_struct<"f">( 1.0 ); <-- will produce f: got double 1
+/// \endcode
+///
+template< fixed_string tag_, Structure S, typename T >
+constexpr auto upgrade_struct( S&& structure, T&& value ) noexcept
+{
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
+    {
+        constexpr std::size_t index = detail::index_of<tag_, std::remove_cvref_t<MS>...>();
+        if constexpr ( index < sizeof...(MS) )
+            return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+            {
+                return create_struct( detail::upgrade_if<Is == index, tag_>( std::forward<MS>(members), std::forward<T>(value) )...  );
+            }( std::index_sequence_for<MS...>{} );
+        else
+            return create_struct( std::forward<MS>(members)..., make_member<tag_>( std::forward<T>(value) ) );
+    } );
+}
+
+
+namespace detail
+{
+
+// the fields of a pending chain: a field of the source, the value of an operation, or the value of an operation upgrading another field
+template< std::size_t K, typename M >
+struct lazy_source { typedef M member_type; };
+
+template< std::size_t J, typename M >
+struct lazy_value { typedef M member_type; };
+
+template< std::size_t J, typename M, typename E >
+struct lazy_upgrade { typedef M member_type; };
+
+template< typename E >
+constexpr bool is_lazy_source_v = false;
+
+template< std::size_t K, typename M >
+constexpr bool is_lazy_source_v< lazy_source<K, M> > = true;
+
+template< typename ... Es >
+struct lazy_fields
+{
+    static constexpr std::size_t size = sizeof...(Es);
+
+    template< fixed_string tag_ >
+    static constexpr std::size_t index = index_of<tag_, typename Es::member_type...>();
+};
+
+template< typename ... Ms >
+struct lazy_fields_of< storage<Ms...> >
+{
+    typedef decltype( []<std::size_t ... Is>( std::index_sequence<Is...> ) { return lazy_fields<lazy_source<Is, Ms>...>{}; }( std::index_sequence_for<Ms...>{} ) ) type;
+};
+
+// the fields after replacing the field at `P` by `E`, or appending `E` if `P` is past the end
+template< std::size_t P, typename E, typename ... Es >
+constexpr auto lazy_replace( lazy_fields<Es...> ) noexcept
+{
+    if constexpr ( P == sizeof...(Es) )
+        return lazy_fields<Es..., E>{};
+    else
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) { return lazy_fields<std::conditional_t<Is == P, E, type_at<Is, Es...>>...>{}; }( std::index_sequence_for<Es...>{} );
+}
+
+// the fields without the field at `P`, if there is one
+template< std::size_t P, typename ... Es >
+constexpr auto lazy_remove( lazy_fields<Es...> fields ) noexcept
+{
+    if constexpr ( P == sizeof...(Es) )
+        return fields;
+    else
+    {
+        constexpr auto kept = indices_without<sizeof...(Es), P>();
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) { return lazy_fields<type_at<kept[Is], Es...>...>{}; }( std::make_index_sequence<sizeof...(Es)-1>{} );
+    }
+}
+
+// the field upgrading the field at `P` with the value of the operation `J`: the value replaces the field if it has the same type, or is appended if there is no field at `P`
+template< std::size_t J, fixed_string tag_, typename T, std::size_t P, typename ... Es >
+constexpr auto lazy_upgrade_of( lazy_fields<Es...> ) noexcept
+{
+    if constexpr ( P == sizeof...(Es) )
+        return lazy_value<J, member<tag_, T>>{};
+    else if constexpr ( std::is_same_v<T, typename type_at<P, Es...>::member_type::value_type> )
+        return lazy_value<J, member<tag_, T>>{};
+    else
+        return lazy_upgrade<J, member<tag_, overload<T, typename type_at<P, Es...>::member_type::value_type>>, type_at<P, Es...>>{};
+}
+
+template< std::size_t J, typename T >
+struct lazy_slot
+{
+    T value;
+};
+
+// the values of the pending operations, the J-th one in `lazy_slot<J, T>`
+template< typename Js, typename ... Ts >
+struct lazy_values;
+
+template< std::size_t ... Js, typename ... Ts >
+struct lazy_values< std::index_sequence<Js...>, Ts... > : lazy_slot<Js, Ts>... {};
+
+template< std::size_t J, typename T >
+constexpr T& slot( lazy_slot<J, T>& s ) noexcept { return s.value; }
+
+template< std::size_t J, typename T >
+constexpr T const& slot( lazy_slot<J, T> const& s ) noexcept { return s.value; }
+
+// marks in `used` the values a field reads
+template< std::size_t N, std::size_t K, typename M >
+constexpr void lazy_mark( std::array<bool, N>&, lazy_source<K, M> ) noexcept {}
+
+template< std::size_t N, std::size_t J, typename M >
+constexpr void lazy_mark( std::array<bool, N>& used, lazy_value<J, M> ) noexcept { used[J] = true; }
+
+template< std::size_t N, std::size_t J, typename M, typename E >
+constexpr void lazy_mark( std::array<bool, N>& used, lazy_upgrade<J, M, E> ) noexcept { used[J] = true; lazy_mark( used, E{} ); }
+
+// the operations, out of `N`, whose values are read by the fields: the values of an update or an upgrade replaced or deleted afterwards are not
+template< std::size_t N, typename ... Es >
+constexpr std::array<bool, N> lazy_used( lazy_fields<Es...> ) noexcept
+{
+    std::array<bool, N> used{};
+    ( lazy_mark( used, Es{} ), ... );
+    return used;
+}
+
+// the operations whose values are read by `Fields`, in order
+template< std::size_t N, typename Fields >
+constexpr auto lazy_kept() noexcept
+{
+    constexpr auto used = lazy_used<N>( Fields{} );
+    std::array<std::size_t, std::count( used.begin(), used.end(), true )> ans{};
+    for ( std::size_t j = 0, k = 0; j != N; ++j )
+        if ( used[j] ) ans[k++] = j;
+    return ans;
+}
+
+template< std::size_t N, typename Fields >
+constexpr auto lazy_kept_v = lazy_kept<N, Fields>();
+
+// the position of each operation in `lazy_kept_v`
+template< std::size_t N, typename Fields >
+constexpr std::array<std::size_t, N> lazy_index() noexcept
+{
+    std::array<std::size_t, N> ans{};
+    for ( std::size_t k = 0; k != lazy_kept_v<N, Fields>.size(); ++k )
+        ans[lazy_kept_v<N, Fields>[k]] = k;
+    return ans;
+}
+
+// the field reading the value `index[J]` instead of `J`
+template< auto index, std::size_t K, typename M >
+constexpr auto lazy_renumber( lazy_source<K, M> e ) noexcept { return e; }
+
+template< auto index, std::size_t J, typename M >
+constexpr auto lazy_renumber( lazy_value<J, M> ) noexcept { return lazy_value<index[J], M>{}; }
+
+template< auto index, std::size_t J, typename M, typename E >
+constexpr auto lazy_renumber( lazy_upgrade<J, M, E> ) noexcept { return lazy_upgrade<index[J], M, decltype( lazy_renumber<index>( E{} ) )>{}; }
+
+template< auto index, typename ... Es >
+constexpr auto lazy_renumber( lazy_fields<Es...> ) noexcept { return lazy_fields<decltype( lazy_renumber<index>( Es{} ) )...>{}; }
+
+}//namespace detail
+
+///
+/// @brief A chain of pending CRUD operations on a meta structure, returned by `s.lazy()`.
+///        The operations only compute the fields of the result at compile time, and keep their values: the resulting structure is constructed once,
+///        when the chain is converted to a structure, and a field is read without constructing any structure.
+///        An update or an upgrade followed by a delete of the same tag, or by another update, leaves nothing in the result, and its value is not kept in the chain.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( m1, m2, m3 );
+/// constexpr auto t = s.lazy().update<"one">( 1.0f ).destroy<"two">().add<"four">( 4 ).materialize();
+/// \endcode
+///
+template< typename Source, typename ... Es, typename ... Ts >
+class lazy_struct< Source, detail::lazy_fields<Es...>, Ts... >
+{
+    typedef detail::lazy_fields<Es...> fields_type;
+    typedef detail::lazy_values<std::index_sequence_for<Ts...>, Ts...> values_type;
+
+public:
+    Source source_;
+    values_type values_;
+
+private:
+    // the value of the operation `J`, moved from if `Self` is an rvalue
+    template< std::size_t J, typename Self >
+    static constexpr decltype(auto) forward_value( Self& self ) noexcept
     {
-        return read_struct<tag_>( *this );
+        if constexpr ( std::is_const_v<Self> ) return detail::slot<J>( self.values_ );
+        else return std::move( detail::slot<J>( self.values_ ) );
     }
 
-    template< fixed_string tag_>
-    constexpr auto retrieve() const noexcept
+    // the source, moved from if `Self` is an rvalue
+    template< typename Self >
+    static constexpr decltype(auto) forward_source( Self& self ) noexcept
     {
-        return read<tag_>();
+        return std::forward<std::conditional_t<std::is_const_v<Self>, Source const&, Source>>( self.source_ );
     }
 
-    template< fixed_string tag_>
-    constexpr auto get() const noexcept
+    // the next link of the chain with `Fields`, holding only the values they read, renumbered: `value.template operator()<J>()` is the value of the operation `J`, of type `Vs...[J]`, and `value.template operator()<sizeof...(Vs)>()` the source
+    template< typename Fields, typename ... Vs, typename Value >
+    static constexpr auto link( Value&& value ) noexcept
     {
-        return read<tag_>();
+        constexpr std::size_t n = detail::lazy_kept_v<sizeof...(Vs), Fields>.size();
+        using fields = decltype( detail::lazy_renumber<detail::lazy_index<sizeof...(Vs), Fields>()>( Fields{} ) );
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+        {
+            return lazy_struct<Source, fields, detail::type_at<detail::lazy_kept_v<sizeof...(Vs), Fields>[Is], Vs...>...>{ value.template operator()<sizeof...(Vs)>(),
+                   { detail::lazy_slot<Is, detail::type_at<detail::lazy_kept_v<sizeof...(Vs), Fields>[Is], Vs...>>{ value.template operator()<detail::lazy_kept_v<sizeof...(Vs), Fields>[Is]>() }... } };
+        }( std::make_index_sequence<n>{} );
     }
 
-    template< fixed_string tag_>
-    constexpr auto browse() const noexcept
+    // the next link of the chain, holding the values of this one still read and `value`
+    template< typename Fields, typename Self, typename T >
+    static constexpr auto chain( Self& self, T&& value ) noexcept
     {
-        return read<tag_>();
+        return link<Fields, Ts..., std::decay_t<T>>( [&]<std::size_t J>() noexcept -> decltype(auto)
+        {
+            if constexpr ( J == sizeof...(Ts) + 1 ) return forward_source( self );
+            else if constexpr ( J == sizeof...(Ts) ) return std::forward<T>(value);
+            else return forward_value<J>( self );
+        } );
     }
 
-    template< fixed_string tag_>
-    constexpr auto view() const noexcept
+    // the next link of the chain without the field at `P`, and without the values only it read
+    template< std::size_t P, typename Self >
+    static constexpr auto drop( Self& self ) noexcept
     {
-        return read<tag_>();
+        return link<decltype( detail::lazy_remove<P>( fields_type{} ) ), Ts...>( [&]<std::size_t J>() noexcept -> decltype(auto)
+        {
+            if constexpr ( J == sizeof...(Ts) ) return forward_source( self );
+            else return forward_value<J>( self );
+        } );
     }
 
-    //
-    // update, put, change, edit
-    //
+    // the member of the result described by a field, the source and the values are moved from if `Self` is not const
+    template< typename Self, std::size_t K, typename M >
+    static constexpr M member_of( Self& self, detail::lazy_source<K, M> ) noexcept
+    {
+        if constexpr ( std::is_const_v<Self> || std::is_reference_v<Source> ) return detail::get<K>( std::as_const( self.source_ ).s_ );
+        else return detail::get<K>( std::move( self.source_.s_ ) );
+    }
 
-    template< fixed_string tag_, typename T >
-    constexpr auto update( T const& value ) const noexcept
+    template< typename Self, std::size_t J, typename M >
+    static constexpr M member_of( Self& self, detail::lazy_value<J, M> ) noexcept
     {
-        return update_struct<tag_>( *this, value );
+        return M{ forward_value<J>( self ) };
     }
 
-    template< fixed_string tag_, typename T >
-    constexpr auto put( T const& value ) const noexcept
+    template< typename Self, std::size_t J, typename M, typename E >
+    static constexpr M member_of( Self& self, detail::lazy_upgrade<J, M, E> ) noexcept
     {
-        return update<tag_>( value );
+        return M{ overload( forward_value<J>( self ), member_of( self, E{} ).value() ) };
     }
 
-    template< fixed_string tag_, typename T >
-    constexpr auto change( T const& value ) const noexcept
+    template< std::size_t K, typename M >
+    constexpr decltype(auto) value_of( detail::lazy_source<K, M> ) const noexcept
     {
-        return update<tag_>( value );
+        if constexpr ( is_computed_v<typename M::value_type> )
+        {
+            static_assert( !( ( !detail::is_lazy_source_v<Es> && M::value_type::template depends_on<Es::member_type::tag()>() ) || ... ),
+                           "A field this computed member depends on is pending: materialize the chain first." );
+            return detail::get<K>( source_.s_ ).value().get( source_ );
+        }
+        else
+            return detail::get<K>( source_.s_ ).value();
     }
 
-    template< fixed_string tag_, typename T >
-    constexpr auto edit( T const& value ) const noexcept
+    // clears the caches of the computed members of the result depending on a pending field
+    template< typename S >
+    static constexpr void invalidate_pending( S const& s ) noexcept
     {
-        return update<tag_>( value );
+        ( [&]<typename E>( E ) noexcept { if constexpr ( !detail::is_lazy_source_v<E> ) detail::invalidate_dependents<E::member_type::tag()>( s ); }( Es{} ), ... );
     }
 
+    template< std::size_t J, typename M >
+    constexpr decltype(auto) value_of( detail::lazy_value<J, M> ) const noexcept { return detail::slot<J>( values_ ); }
 
-    //
-    // (delete), destroy, remove, erase
-    //
+    template< std::size_t J, typename M, typename E >
+    constexpr auto value_of( detail::lazy_upgrade<J, M, E> e ) const noexcept { return member_of( *this, e ).value(); }
 
-    template< fixed_string tag_ >
-    constexpr auto destroy() const noexcept
+    template< fixed_string tag_, typename Self, typename T >
+    static constexpr auto upgrade_of( Self& self, T&& value ) noexcept
     {
-        return delete_struct<tag_>( *this );
+        constexpr std::size_t index = fields_type::template index<tag_>;
+        using E = decltype( detail::lazy_upgrade_of<sizeof...(Ts), tag_, std::decay_t<T>, index>( fields_type{} ) );
+        return chain<decltype( detail::lazy_replace<index, E>( fields_type{} ) )>( self, std::forward<T>(value) );
     }
 
+public:
+    static constexpr std::size_t size() noexcept { return fields_type::size; }
+
     template< fixed_string tag_ >
-    constexpr auto remove() const noexcept
+    static constexpr bool has() noexcept
     {
-        return destroy<tag_>();
+        return fields_type::template index<tag_> < size();
     }
 
-    template< fixed_string tag_ >
-    constexpr auto erase() const noexcept
+    template< fixed_string tag_, typename T >
+    constexpr auto update( T&& value ) const& noexcept
     {
-        return destroy<tag_>();
+        return chain<decltype( detail::lazy_replace<fields_type::template index<tag_>, detail::lazy_value<sizeof...(Ts), member<tag_, std::decay_t<T>>>>( fields_type{} ) )>( *this, std::forward<T>(value) );
     }
 
-
-    //
-    // map, for_each
-    //
-
-    template<typename F >
-    constexpr auto map( F&& function )
+    template< fixed_string tag_, typename T >
+    constexpr auto update( T&& value ) && noexcept
     {
-        return map_struct( *this, function );
+        return chain<decltype( detail::lazy_replace<fields_type::template index<tag_>, detail::lazy_value<sizeof...(Ts), member<tag_, std::decay_t<T>>>>( fields_type{} ) )>( *this, std::forward<T>(value) );
     }
 
-    template<typename F >
-    constexpr auto for_each( F&& function )
+    template< fixed_string tag_, typename T >
+    constexpr auto add( T&& value ) const& noexcept
     {
-        return map( function );
+        static_assert( !has<tag_>(), "A tag is used by more than one field of the structure." );
+        return update<tag_>( std::forward<T>(value) );
     }
 
-
-    //
-    // add, append, insert
-    //
     template< fixed_string tag_, typename T >
-    constexpr auto add( T const& value ) const noexcept
+    constexpr auto add( T&& value ) && noexcept
     {
-        return cons( (*this), create_structure( make_member<tag_>( value ) ) );
+        static_assert( !has<tag_>(), "A tag is used by more than one field of the structure." );
+        return std::move(*this).template update<tag_>( std::forward<T>(value) );
     }
 
     template< fixed_string tag_, typename T >
-    constexpr auto append( T const& value ) const noexcept
+    constexpr auto upgrade( T&& value ) const& noexcept
     {
-        return add<tag_>( value );
+        return upgrade_of<tag_>( *this, std::forward<T>(value) );
     }
 
     template< fixed_string tag_, typename T >
-    constexpr auto insert( T const& value ) const noexcept
+    constexpr auto upgrade( T&& value ) && noexcept
     {
-        return add<tag_>( value );
+        return upgrade_of<tag_>( *this, std::forward<T>(value) );
     }
 
-    //
-    // has, contains
-    //
+    // a deleted field is dropped from the fields of the result, with the operations which set it and their values
+    template< fixed_string tag_ >
+    constexpr auto destroy() const& noexcept
+    {
+        return drop<fields_type::template index<tag_>>( *this );
+    }
 
     template< fixed_string tag_ >
-    constexpr bool has()  const noexcept
+    constexpr auto destroy() && noexcept
     {
-        return struct_has<tag_>( *this );
+        return drop<fields_type::template index<tag_>>( *this );
     }
 
+    ///
+    /// @brief READ a field of the result without constructing the result: a field of the source or a pending value is returned by reference.
+    ///
     template< fixed_string tag_ >
-    constexpr bool contain()  const noexcept
+    constexpr decltype(auto) read() const noexcept
     {
-        return has<tag_>();
+        constexpr std::size_t index = fields_type::template index<tag_>;
+        static_assert( index < size(), "This field is not defined in the structure." );
+        return value_of( detail::type_at<index, Es...>{} );
     }
 
-    //
-    // upgrade. Note: this is different from update
-    //
+    ///
+    /// @brief Construct the resulting structure, every field once. The source and the values are moved from when the chain is an rvalue.
+    ///
+    constexpr auto materialize() const& noexcept
+    {
+        auto ans = create_struct( member_of( *this, Es{} )... );
+        invalidate_pending( ans );
+        return ans;
+    }
 
-    template< fixed_string tag_, typename T >
-    constexpr auto upgrade( T const& value ) noexcept
+    constexpr auto materialize() && noexcept
     {
-        return upgrade_struct( *this, value );
+        auto ans = create_struct( member_of( *this, Es{} )... );
+        invalidate_pending( ans );
+        return ans;
     }
 
-};//struct structure
+    template< typename S >
+    requires std::is_same_v<S, decltype( std::declval<lazy_struct const&>().materialize() )>
+    constexpr operator S() const& noexcept
+    {
+        return materialize();
+    }
 
-template< typename T >
-struct is_structure : std::false_type {};
+    template< typename S >
+    requires std::is_same_v<S, decltype( std::declval<lazy_struct const&>().materialize() )>
+    constexpr operator S() && noexcept
+    {
+        return std::move(*this).materialize();
+    }
+};//class lazy_struct
+
+namespace detail
+{
+
+template< typename S >
+struct storage_traits;
 
+// a value whose bytes are its value and whose `==` compares them: an integer, an enum or a pointer, or an array of them;
+// a class such as `std::string_view` is trivially copyable without padding, but its `==` compares what it refers to
 template< typename T >
-struct is_structure< structure<T> > : std::true_type {};
+inline constexpr bool is_bulk_v = std::is_scalar_v<T> && std::has_unique_object_representations_v<T>;
+
+template< typename T, std::size_t N >
+inline constexpr bool is_bulk_v< T[N] > = is_bulk_v<T>;
+
+template< typename T, std::size_t N >
+inline constexpr bool is_bulk_v< std::array<T, N> > = is_bulk_v<T>;
 
 template< typename T >
-constexpr bool is_structure_v = is_structure<T>::value;
+constexpr bool is_hashable() noexcept;
+
+template< typename ... Ms >
+struct storage_traits< storage<Ms...> >
+{
+    static constexpr std::size_t size = sizeof...(Ms);
+    static constexpr std::array<std::size_t, size> sizes = { sizeof(Ms)... };
+    static constexpr std::array<std::size_t, size> alignments = { alignof(Ms)... };
+    static constexpr std::array<std::string_view, size> tags = { std::string_view{ tag_of<Ms::tag()>::value.data } ... };
+    // fields whose bytes are their value: compared and hashed in bulk with their contiguous neighbours
+    static constexpr std::array<bool, size> bulk = { is_bulk_v<typename Ms::value_type>... };
+    // computed fields are derived from the others, and ignored by comparisons and hashes
+    static constexpr bool equality_comparable = ( ( is_computed_v<typename Ms::value_type> || std::equality_comparable<typename Ms::value_type> ) && ... );
+    static constexpr bool three_way_comparable = ( ( is_computed_v<typename Ms::value_type> || std::three_way_comparable<typename Ms::value_type> ) && ... );
+    static constexpr bool hashable = ( is_hashable<typename Ms::value_type>() && ... );
+};
 
 template< typename T >
-concept Structure = is_structure_v<T>;
+constexpr bool is_hashable() noexcept
+{
+    if constexpr ( is_computed_v<T> || is_bulk_v<T> ) return true;
+    else if constexpr ( is_structure_v<T> ) return storage_traits<decltype(T::s_)>::hashable;
+    else if constexpr ( std::ranges::contiguous_range<T const> && std::ranges::sized_range<T const> ) return is_bulk_v<std::ranges::range_value_t<T const>> || requires( T const& value ) { std::hash<T>{}( value ); };
+    else return requires( T const& value ) { std::hash<T>{}( value ); };
+}
+
+constexpr std::size_t round_up( std::size_t offset, std::size_t alignment ) noexcept
+{
+    return ( offset + alignment - 1 ) / alignment * alignment;
+}
+
+struct extent
+{
+    std::size_t size;
+    std::size_t alignment;
+};
 
 ///
-/// @brief CREATE a meta structure with one or more members (fields).
-/// Example:
-/// \code{.cpp}
-/// constexpr auto m1 = make_member<"one">(1);
-/// constexpr auto m2 = make_member<"two">(2UL);
-/// constexpr auto m3 = make_member<"three">(2.0f);
-/// constexpr auto s = create_struct( m1, m2, m3 );
-/// \endcode
+/// @brief Mirror the layout of `storage` for the members [first, first+count), `depth` levels deep: each level lays out up to 8 items in order,
+///        an item being a member at the last level, or a nested block of the level below. `offsets` of these members are expected to be zero.
 ///
-template< Member ... Members >
-constexpr auto create_struct(Members const& ... members) noexcept
+template< std::size_t N >
+constexpr extent place_storage( std::array<std::size_t, N> const& sizes, std::array<std::size_t, N> const& alignments, std::array<std::size_t, N>& offsets, std::size_t first, std::size_t count, std::size_t depth ) noexcept
 {
-    return structure{ [=]<typename F>( F&& function ) noexcept { if constexpr (sizeof...(Members)>=1) return std::forward<F>(function)( members... ); } };
+    std::size_t span = 1;
+    for ( std::size_t level = 1; level < depth; ++level )
+        span *= 8;
+
+    std::size_t offset = 0;
+    std::size_t alignment = 1;
+    for ( std::size_t item = first; item < first + count; item += span )
+    {
+        std::size_t const items = std::min( span, first + count - item );
+        extent const ext = depth == 1 ? extent{ sizes[item], alignments[item] } : place_storage( sizes, alignments, offsets, item, items, depth - 1 );
+        offset = round_up( offset, ext.alignment );
+        for ( std::size_t index = item; index < item + items; ++index )
+            offsets[index] += offset;
+        offset += ext.size;
+        alignment = std::max( alignment, ext.alignment );
+    }
+    return extent{ offset == 0 ? 1 : round_up( offset, alignment ), alignment };
 }
 
-template< Member ... Members >
-constexpr auto make_struct(Members const& ... members) noexcept
+///
+/// @brief Field order minimizing the padding: decreasing alignment, then decreasing size, then order of creation.
+///
+template< std::size_t N >
+constexpr std::array<std::size_t, N> packed_order( std::array<std::size_t, N> const& sizes, std::array<std::size_t, N> const& alignments ) noexcept
 {
-    return create_struct( members... );
+    auto const before = [&]( std::size_t lhs, std::size_t rhs ) noexcept
+    {
+        if ( alignments[lhs] != alignments[rhs] ) return alignments[lhs] > alignments[rhs];
+        return sizes[lhs] > sizes[rhs];
+    };
+
+    // insertion sort, as std::stable_sort is not constexpr
+    std::array<std::size_t, N> order{};
+    for ( std::size_t index = 0; index < N; ++index )
+    {
+        std::size_t position = index;
+        for ( ; position > 0 && before( index, order[position-1] ); --position )
+            order[position] = order[position-1];
+        order[position] = index;
+    }
+    return order;
 }
 
+}//namespace detail
+
 ///
-/// @brief concatenate_struct two or more meta structures.
+/// @brief Memory layout of a meta structure, fields are listed in order of storage.
+///
+template< std::size_t N >
+struct layout
+{
+    std::size_t size;                           ///< sizeof the structure
+    std::size_t alignment;                      ///< alignof the structure
+    std::size_t padding;                        ///< bytes not occupied by any field
+    std::array<std::string_view, N> tags;       ///< tag of each field
+    std::array<std::size_t, N> offsets;         ///< offset of each field
+    std::array<std::size_t, N> sizes;           ///< sizeof each field
+
+    // an unknown tag does not compile in a constant expression, and throws `std::out_of_range` otherwise; `offset_of<tag_>( s )` checks it with a static_assert
+    constexpr std::size_t offset_of( std::string_view tag ) const
+    {
+        std::size_t const index = std::find( tags.begin(), tags.end(), tag ) - tags.begin();
+        if ( index == N ) throw std::out_of_range{ "This field is not defined in the structure." };
+        return offsets[index];
+    }
+};//struct layout
+
+///
+/// @brief Compile-time LAYOUT report of a meta structure.
 /// Example:
 /// \code{.cpp}
-/// constexpr auto s1 = create_struct( m1, m2 );
-/// constexpr auto s2 = create_struct( m3 );
-/// constexpr auto s3 = concatenate_struct( s1, s2 );
-/// constexpr auto s4 = concatenate_struct( s1, s2, s3 );
+/// constexpr auto s = create_struct( make_member<"a">( 'a' ), make_member<"b">( 1.0 ), make_member<"c">( 'c' ) );
+/// static_assert( layout_of( s ).padding == 14 );
+/// static_assert( layout_of( s ).offset_of( "b" ) == 8 );
 /// \endcode
 ///
-template< Structure S1, Structure S2 >
-constexpr auto concatenate_struct(S1 const& structure1, S2 const& structure2) noexcept
+template< Structure S >
+constexpr auto layout_of() noexcept
 {
-    return structure1( [&]<Member ... MS>(MS const& ... members) noexcept
-    {
-        return structure2( [&]<Member ... MT>(MT const& ... members2) noexcept { return create_struct(members..., members2...); }); }
-    );
+    using traits = detail::storage_traits<decltype(std::remove_cvref_t<S>::s_)>;
+    layout<traits::size> ans{ 0, 0, 0, traits::tags, {}, traits::sizes };
+    detail::extent const ext = detail::place_storage( traits::sizes, traits::alignments, ans.offsets, 0, traits::size, detail::depth_of( traits::size ) );
+    ans.size = ext.size;
+    ans.alignment = ext.alignment;
+    ans.padding = ext.size;
+    for ( std::size_t size : traits::sizes )
+        ans.padding -= size;
+    return ans;
 }
 
-template< Structure S,  Structure ... SS >
-constexpr auto concatenate_struct(S const& s, SS const& ... ss ) noexcept
+template< Structure S >
+constexpr auto layout_of( S const& ) noexcept
 {
-    if constexpr (sizeof...(SS) == 0 ) return s;
-    else return concatenate_struct(s, concatenate_struct(ss...));
+    constexpr auto ans = layout_of<S>();
+    static_assert( ans.size == sizeof(S) && ans.alignment == alignof(S), "Unexpected storage layout." );
+    return ans;
 }
 
-template< typename ... TS >
-constexpr auto cons( TS const& ... ts ) noexcept
+///
+/// @brief OFFSET of a field in a meta structure. If not find this filed, will trigger a compilation error.
+/// Example:
+/// \code{.cpp}
+/// constexpr auto s = create_struct( make_member<"a">( 'a' ), make_member<"b">( 1.0 ), make_member<"c">( 'c' ) );
+/// static_assert( offset_of<"b">( s ) == 8 );
+/// \endcode
+///
+template< fixed_string tag_, Structure S >
+constexpr std::size_t offset_of() noexcept
 {
-    return concatenate_struct( ts... );
+    constexpr std::size_t index = detail::index_of_tag<tag_, decltype(std::remove_cvref_t<S>::s_)>::value;
+    static_assert( index < std::remove_cvref_t<S>::size(), "This field is not defined in the structure." );
+    return layout_of<S>().offsets[index];
 }
 
-
+template< fixed_string tag_, Structure S >
+constexpr std::size_t offset_of( S const& ) noexcept
+{
+    return offset_of<tag_, S>();
+}
 
 ///
-/// @brief READ a field from a meta structure. If not find this filed, will trigger a compilation error.
+/// @brief PACK a meta structure, by reordering its fields to minimize the padding. Fields are still accessed by tag.
 /// Example:
 /// \code{.cpp}
-/// constexpr auto s = create_struct( m1, m2, m3 );
-/// constexpr auto v = read_struct<"one">( s );
+/// constexpr auto s = create_struct( make_member<"a">( 'a' ), make_member<"b">( 1.0 ), make_member<"c">( 'c' ) ); // sizeof(s) == 24
+/// constexpr auto t = pack_struct( s ); // sizeof(t) == 16
 /// \endcode
 ///
-template< fixed_string tag_, Structure S >
-constexpr auto read_struct( S const& structure ) noexcept
+template< Structure S >
+constexpr auto pack_struct( S&& structure ) noexcept
 {
-    return structure( [&]<Member M, Member ... MS>( M const& member1, MS const& ... members ) noexcept
+    using traits = detail::storage_traits<decltype(std::remove_cvref_t<S>::s_)>;
+    constexpr auto order = detail::packed_order( traits::sizes, traits::alignments );
+    return std::forward<S>(structure)( [&]<Member ... MS>( MS&& ... members ) noexcept
     {
-        if constexpr ( M::tag() == tag_ )
-            return member1.value();
-        else
+        auto const pack = detail::make_pack( std::forward<MS>(members)... );
+        return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
         {
-            static_assert( sizeof...(MS) > 0, "This field is not defined in the structure." );
-            return read_struct<tag_>( create_struct(members...) );
-        }
+            return create_struct( detail::at<order[Is]>( pack )... );
+        }( std::make_index_sequence<sizeof...(MS)>{} );
     } );
 }
 
+namespace detail
+{
+
 ///
-/// @brief UPDATE a field in a meta structure. If not find this filed, a new field <'tag_', value> will be appended.
-/// Example:
-/// \code{.cpp}
-/// constexpr auto s = create_struct( m1, m2, m3 );
-/// constexpr auto t = update_struct<"one">( s, 1.0f );
-/// \endcode
+/// @brief A run of fields compared and hashed together: contiguous bulk fields, or a single other field.
 ///
-template< fixed_string tag_, Structure S, typename T >
-constexpr auto update_struct( S const& structure, T const& value ) noexcept
+struct field_run
+{
+    std::size_t first;
+    std::size_t offset;
+    std::size_t size;
+    bool bulk;
+};
+
+template< Structure S >
+constexpr auto field_runs() noexcept
 {
-    return structure( [&]<Member M, Member ... MS>( M const& member1, MS const& ... members ) noexcept
+    using traits = storage_traits<decltype(S::s_)>;
+    constexpr auto layout = layout_of<S>();
+    std::array<field_run, traits::size> runs{};
+    std::size_t count = 0;
+    for ( std::size_t index = 0; index < traits::size; ++index )
     {
-        if constexpr ( M::tag() == tag_ )
-            return create_struct( make_member<tag_>( value ), members... );
+        bool const bulk = traits::bulk[index] && layout.size == sizeof(S);
+        if ( bulk && count > 0 && runs[count-1].bulk && runs[count-1].offset + runs[count-1].size == layout.offsets[index] )
+            runs[count-1].size += layout.sizes[index];
         else
-        {
-            if constexpr ( sizeof...(MS) > 0 )
-                return concatenate_struct( create_struct(member1), update_struct<tag_>( create_struct(members...), value ) );
-            else
-                return create_struct( member1, make_member<tag_>( value ) );
-        }
-    } );
+            runs[count++] = field_run{ index, layout.offsets[index], layout.sizes[index], bulk };
+    }
+    return std::pair{ runs, count };
+}
+
+template< Structure S >
+inline constexpr auto field_runs_v = field_runs<S>();
+
+// calls `function.template operator()<runs...>()` with the runs of `S`
+template< Structure S, typename F >
+constexpr decltype(auto) with_runs( F&& function ) noexcept
+{
+    return [&]<std::size_t ... Rs>( std::index_sequence<Rs...> ) noexcept -> decltype(auto)
+    {
+        return function.template operator()<field_runs_v<S>.first[Rs]...>();
+    }( std::make_index_sequence<field_runs_v<S>.second>{} );
 }
 
+inline std::byte const* bytes_of( void const* object, std::size_t offset ) noexcept
+{
+    return static_cast<std::byte const*>( object ) + offset;
+}
 
+// one past the last field of the run starting at field `first`
+template< Structure S >
+constexpr std::size_t run_end( std::size_t first ) noexcept
+{
+    auto const& [runs, count] = field_runs_v<S>;
+    for ( std::size_t index = 0; index + 1 < count; ++index )
+        if ( runs[index].first == first ) return runs[index+1].first;
+    return S::size();
+}
 
+// stands for a computed field, equal to any other
+struct ignored_field
+{
+    constexpr auto operator <=> ( ignored_field const& ) const noexcept = default;
+};
 
+template< std::size_t I, Structure S >
+constexpr decltype(auto) compared_field( S const& s ) noexcept
+{
+    if constexpr ( is_computed_v<decltype(get<I>( s.s_ ).value())> ) return ignored_field{};
+    else return get<I>( s.s_ ).value();
+}
 
+template< field_run run, Structure S >
+constexpr bool equal_run( S const& lhs, S const& rhs ) noexcept
+{
+    if constexpr ( run.bulk )
+        if ( !std::is_constant_evaluated() )
+            return std::memcmp( bytes_of( std::addressof( lhs ), run.offset ), bytes_of( std::addressof( rhs ), run.offset ), run.size ) == 0;
+    // fieldwise, also for a bulk run in a constant expression
+    constexpr std::size_t last = run.bulk ? run_end<S>( run.first ) : run.first + 1;
+    return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
+    {
+        return ( ... && ( compared_field<run.first + Is>( lhs ) == compared_field<run.first + Is>( rhs ) ) );
+    }( std::make_index_sequence<last - run.first>{} );
+}
 
 ///
-/// @brief DELETE a field in a meta structure. If not find this filed, return the original structure.
-/// Example:
-/// \code{.cpp}
-/// constexpr auto s = create_struct( m1, m2, m3 );
-/// constexpr auto t = delete_struct<"one">( s );
-/// \endcode
+/// @brief The two halves of the 128-bit product of `x` and `y`, folded.
 ///
-template< fixed_string tag_, Structure S >
-constexpr auto delete_struct( S const& structure ) noexcept
+constexpr std::uint64_t hash_multiply( std::uint64_t x, std::uint64_t y ) noexcept
 {
-    return structure( [&]<Member M, Member ... MS>( M const& member1, MS const& ... members ) noexcept
-    {
-        if constexpr ( M::tag() == tag_ )
-            return create_struct( members... );
-        else
-        {
-            if constexpr ( sizeof...(MS) > 0 )
-                return concatenate_struct( create_struct( member1 ), delete_struct<tag_>( create_struct(members...) ) );
-            else
-                return create_struct( member1 );
-        }
-    } );
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 const product = static_cast<unsigned __int128>( x ) * y;
+    return static_cast<std::uint64_t>( product ) ^ static_cast<std::uint64_t>( product >> 64 );
+#else
+    std::uint64_t const product = x * y;
+    return product ^ std::rotl( product, 29 );
+#endif
+}
+
+inline constexpr std::uint64_t hash_secret = 0xa0761d6478bd642fULL;
+
+constexpr std::uint64_t hash_mix( std::uint64_t hash, std::uint64_t value ) noexcept
+{
+    return hash_multiply( hash ^ value, hash_secret );
+}
+
+template< typename T >
+inline T load_bytes( std::byte const* data ) noexcept
+{
+    T ans;
+    std::memcpy( &ans, data, sizeof(T) );
+    return ans;
 }
 
 ///
-/// @breif MAP a function to each field in the meta structure.
-/// EXAMPLE:
-/// \code{.cpp}
-/// constexpr auto s = create_struct( m1, m2, m3 );
-/// constexpr auto t = map_struct( s, []<Member M>(M const& member) { std::cout << static_cast<std::string>(M::tag()) << ": " << member.value() << std::endl; return member.value(); } );
-/// \endcode
+/// @brief Hash `size` bytes, 16 at a time with one multiplication. Not cryptographic.
+///        The last 1 to 16 bytes are read as two overlapping words, with no call to `memcpy` for a size unknown at compile time.
 ///
-template< Structure S, typename F >
-constexpr auto map_struct( S const& structure, F && function ) noexcept
+inline std::uint64_t hash_bytes( std::byte const* data, std::size_t size, std::uint64_t hash ) noexcept
 {
-    return structure( [&]<Member M, Member ... MS>( M const& member1, MS const& ... members ) noexcept
+    std::size_t rest = size;
+    for ( ; rest > 16; rest -= 16, data += 16 )
+        hash = hash_multiply( load_bytes<std::uint64_t>( data ) ^ hash_secret, load_bytes<std::uint64_t>( data + 8 ) ^ hash );
+    std::uint64_t first = 0, last = 0;
+    if ( rest >= 8 )
     {
-        if constexpr( sizeof...(MS) == 0 )
-            return create_struct( make_member<M::tag()>(std::forward<F>(function)(member1)) );
-        else
-            return concatenate_struct ( create_struct( make_member<M::tag()>(std::forward<F>(function)(member1)) ), map_struct( create_struct(members...), std::forward<F>(function) ) );
+        first = load_bytes<std::uint64_t>( data );
+        last = load_bytes<std::uint64_t>( data + rest - 8 );
+    }
+    else if ( rest >= 4 )
+    {
+        first = load_bytes<std::uint32_t>( data );
+        last = load_bytes<std::uint32_t>( data + rest - 4 );
+    }
+    else if ( rest > 0 )
+    {
+        first = ( std::to_integer<std::uint64_t>( data[0] ) << 16 ) | ( std::to_integer<std::uint64_t>( data[rest/2] ) << 8 ) | std::to_integer<std::uint64_t>( data[rest-1] );
+    }
+    return hash_multiply( first ^ hash_secret ^ size, last ^ hash );
+}
+
+template< Structure S >
+std::uint64_t hash_fields( S const& s, std::uint64_t hash ) noexcept;
+
+// strings and vectors of bulk elements are hashed as bytes, nested structures field by field, the others by `std::hash`
+template< typename T >
+constexpr bool is_bulk_range() noexcept
+{
+    if constexpr ( std::ranges::contiguous_range<T const> && std::ranges::sized_range<T const> ) return is_bulk_v<std::ranges::range_value_t<T const>>;
+    else return false;
+}
+
+template< typename T >
+std::uint64_t hash_field( T const& value, std::uint64_t hash ) noexcept
+{
+    if constexpr ( is_computed_v<T> )
+        return hash;
+    else if constexpr ( is_bulk_v<T> )
+        return hash_bytes( reinterpret_cast<std::byte const*>( std::addressof( value ) ), sizeof(T), hash );
+    else if constexpr ( is_structure_v<T> )
+        return hash_fields( value, hash );
+    else if constexpr ( is_bulk_range<T>() )
+        return hash_bytes( reinterpret_cast<std::byte const*>( std::ranges::data( value ) ), std::ranges::size( value ) * sizeof(std::ranges::range_value_t<T const>), hash );
+    else
+        return hash_mix( hash, std::hash<T>{}( value ) );
+}
+
+template< Structure S >
+std::uint64_t hash_fields( S const& s, std::uint64_t hash ) noexcept
+{
+    with_runs<S>( [&]<field_run ... runs>() noexcept
+    {
+        ( ( hash = runs.bulk ? hash_bytes( bytes_of( std::addressof( s ), runs.offset ), runs.size, hash ) : hash_field( get<runs.first>( s.s_ ).value(), hash ) ), ... );
     } );
+    return hash;
 }
 
+}//namespace detail
+
 ///
-/// @breif CHECK if a field in the meta structure.
-/// EXAMPLE:
-/// \code{.cpp}
-/// constexpr auto s = create_struct( m1, m2, m3 );
-/// constexpr bool has_a = struct_has<"a">( s );
-/// constexpr bool has_b = struct_has<"b">( s );
-/// \endcode
+/// @brief EQUALITY of two meta structures of the same fields, computed fields aside. Contiguous trivially copyable fields without padding are compared with one `memcmp`,
+///        the other fields by `==`.
 ///
-template< fixed_string tag_, Structure S >
-constexpr bool struct_has( S const& structure ) noexcept
+template< typename S >
+requires detail::storage_traits<S>::equality_comparable
+constexpr bool operator == ( structure<S> const& lhs, structure<S> const& rhs ) noexcept
 {
-    return structure( [&]<Member M, Member ... MS>( M const&, MS const& ... members ) noexcept
+    return detail::with_runs<structure<S>>( [&]<detail::field_run ... runs>() noexcept
     {
-        if constexpr ( M::tag() == tag_ )
-            return true;
-        else if constexpr ( sizeof...(MS) == 0 )
-            return false;
-        else
-            return struct_has<tag_>( create_struct(members...) );
+        return ( ... && detail::equal_run<runs>( lhs, rhs ) );
     } );
 }
 
-
 ///
-/// @brief UPGRADE a field in a meta structure, to make this field hold more data.
-///        If not find this filed, a new field <'tag_', value> will be appended.
-///        If find this filed,
-///           if value type is identical, the old value will be replaced,
-///           otherwise, the old value will co-exist with the new one by an `overloaded` object.
+/// @brief ORDER two meta structures of the same fields lexicographically, in the order of the fields. Computed fields are ignored.
 /// Example:
 /// \code{.cpp}
-/// constexpr auto s = create_struct( make_member<"f">( []( int i ){ std::cout << "f: got int " << i << std::endl;} );
-/// constexpr auto t = upgrade_struct<"f">( s, []( double d ){ std::cout << "f: got double " << d << std::endl; } );
-/// read_struct<"f">( 1 ); // <-- will produce f: got int 1
-/// read_struct<"f">( 1.0 ); <-- will produce f: got double 1
+/// auto const a = create_struct( make_member<"x">( 1 ), make_member<"name">( std::string{"b"} ) );
+/// auto const b = create_struct( make_member<"x">( 1 ), make_member<"name">( std::string{"c"} ) );
+/// assert( a < b );
 /// \endcode
 ///
-template< fixed_string tag_, Structure S, typename T >
-constexpr auto upgrade_struct( S const& structure, T const& value ) noexcept
+template< typename S >
+requires detail::storage_traits<S>::three_way_comparable
+constexpr auto operator <=> ( structure<S> const& lhs, structure<S> const& rhs ) noexcept
 {
-    return structure( [&]<Member M, Member ... MS>( M const& m, MS const& ... members ) noexcept
+    return [&]<std::size_t ... Is>( std::index_sequence<Is...> ) noexcept
     {
-        if constexpr ( M::tag() == tag_ )
-        {
-            if constexpr ( std::is_same_v<T, typename M::value_type> )
-                return create_struct( make_member<tag_>( value ), members... );
-            else
-                return create_struct( make_member<tag_>( overload( value, m.value() ) ), members... );
-        }
-        else if constexpr ( sizeof...(MS) == 0 )
-            return create_struct( m, make_member<tag_>( value ) );
-        else
-            return concatenate_struct( create_struct( m ), upgrade_struct<tag_>( create_struct( members... ) ) );
-    } );
+        using ordering = std::common_comparison_category_t<std::compare_three_way_result_t<std::remove_cvref_t<decltype( detail::compared_field<Is>( lhs ) )>>...>;
+        ordering ans = std::strong_ordering::equal;
+        // stops at the first field which differs
+        ( ( ( ans = std::compare_three_way{}( detail::compared_field<Is>( lhs ), detail::compared_field<Is>( rhs ) ) ) == 0 ) && ... );
+        return ans;
+    }( std::make_index_sequence<structure<S>::size()>{} );
 }
 
+///
+/// @brief HASH a meta structure, computed fields aside. Contiguous trivially copyable fields without padding are hashed in bulk, as bytes, and so are strings and vectors of them.
+///        Not cryptographic, and not stable across platforms.
+///
+template< Structure S >
+requires detail::storage_traits<decltype(std::remove_cvref_t<S>::s_)>::hashable
+std::size_t hash_struct( S const& s, std::uint64_t seed = 0 ) noexcept
+{
+    // a last multiplication, so that every bit of the hash depends on every field
+    return static_cast<std::size_t>( detail::hash_mix( detail::hash_fields( s, seed ), 0xe7037ed1a0b428dbULL ) );
+}
 
 }//namespace meta
 
+///
+/// @brief Meta structures are keys of unordered containers, when their fields are hashable.
+///
+template< typename S >
+requires meta::detail::storage_traits<S>::hashable
+struct std::hash< meta::structure<S> >
+{
+    std::size_t operator()( meta::structure<S> const& s ) const noexcept
+    {
+        return meta::hash_struct( s );
+    }
+};
+
 #endif//META_STRUCTURE_HPP_INCLUDED_ASDLJOP4IJALKJASLKJDASFLKSDJSADFKJASDFOKJSDF
@@ -1,7 +1,44 @@
 #include "./meta_structure.hpp"
+#include "./meta_soa_vector.hpp"
+#include "./meta_serialize.hpp"
+#include "./meta_json.hpp"
+#include "./meta_csv.hpp"
+#include "./meta_parallel.hpp"
+#include "./meta_atomic.hpp"
+#include "./meta_any.hpp"
+#include "./meta_patch.hpp"
+#include "./meta_pmr.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// prints what is checked, and fails the run when it does not hold
+void check( bool ok, std::string_view what )
+{
+    std::cout << what << ": " << ( ok ? "ok" : "FAILED" ) << std::endl;
+    if ( !ok ) std::exit( 1 );
+}
 
 // create
 void test_create()
@@ -39,6 +76,15 @@ void test_read()
     std::cout << "read two: " << s.read<"two">() << std::endl;
     std::cout << "read three: " << read_struct<"three">( s ) << std::endl;
     std::cout << "read three: " << s.read<"three">() << std::endl;
+
+    static_assert( std::is_same_v<decltype(read_struct<"two">( s )), unsigned long const&> );
+    static_assert( std::is_same_v<decltype(s.get<"two">()), unsigned long const&> && std::is_same_v<decltype(s.view<"two">()), unsigned long const&> );
+    static_assert( std::is_same_v<decltype(s.retrieve<"two">()), unsigned long const&> && std::is_same_v<decltype(s.browse<"two">()), unsigned long const&> );
+    static_assert( read_struct<"three">( s ) == 3.0f );
+
+    auto w = create_struct( make_member<"name">( std::string{"meta"} ), make_member<"id">( 42 ) );
+    std::string const& name = w.ref<"name">();
+    check( &name == &read_struct<"name">( w ) && name == "meta", "ref refers to the field" );
     std::cout << "---------------------------------------------------------\n";
 }
 
@@ -155,25 +201,13 @@ void test_has()
     std::cout << "created structure:\n" << std::endl;
     map_struct( s, print_func );
 
-    {
-        constexpr bool has_one = struct_has<"one">( s );
-        if ( has_one )
-            std::cout << "struct has field ONE.\n";
-        else
-            std::cout << "struct does not have field ONE.\n";
-    }
+    check( struct_has<"one">( s ), "struct has field ONE" );
 
 
     auto constexpr t = delete_struct<"one">( s );
     std::cout << "\nafter delete 'one', the structure becomes:" << std::endl;
     map_struct( t, print_func );
-    {
-        constexpr bool has_one = struct_has<"one">( t );
-        if ( has_one )
-            std::cout << "struct has field ONE.\n";
-        else
-            std::cout << "struct does not have field ONE.\n";
-    }
+    check( !struct_has<"one">( t ), "struct does not have field ONE" );
 
 
     std::cout << "---------------------------------------------------------\n";
@@ -195,7 +229,916 @@ void test_upgrade()
     read_struct<"func">(S)( 1.0 );
 }
 
+// counts its own copies through a pointer, so that it is usable in constant expressions
+struct counted
+{
+    int* copies_;
+    constexpr counted( int* copies ) noexcept : copies_{ copies } {}
+    constexpr counted( counted const& other ) noexcept : copies_{ other.copies_ } { ++*copies_; }
+    constexpr counted( counted&& other ) noexcept = default;
+    constexpr counted& operator = ( counted const& other ) noexcept { copies_ = other.copies_; ++*copies_; return *this; }
+    constexpr counted& operator = ( counted&& other ) noexcept = default;
+};
+
+// move
+void test_move()
+{
+    std::cout << std::endl << "test MOVE" << std::endl;
+    using namespace meta;
+
+    constexpr auto copies_on_rvalue_path = []()
+    {
+        int copies = 0;
+        auto s = create_struct( make_member<"a">( counted{&copies} ), make_member<"b">( counted{&copies} ), make_member<"c">( counted{&copies} ) );
+        auto t = std::move(s).update<"a">( counted{&copies} ).destroy<"b">().add<"d">( counted{&copies} ).upgrade<"c">( counted{&copies} );
+        auto u = concatenate_struct( std::move(t), create_struct( make_member<"e">( counted{&copies} ) ) );
+        auto v = delete_struct<"e">( update_struct<"f">( std::move(u), counted{&copies} ) );
+        return v.has<"f">() ? copies : -1;
+    }();
+    static_assert( copies_on_rvalue_path == 0 );
+    std::cout << "copies on the rvalue path: " << copies_on_rvalue_path << std::endl;
+
+    constexpr auto copies_on_lvalue_path = []()
+    {
+        int copies = 0;
+        auto const s = create_struct( make_member<"a">( counted{&copies} ), make_member<"b">( counted{&copies} ), make_member<"c">( counted{&copies} ) );
+        auto const t = s.update<"a">( counted{&copies} );
+        return t.has<"a">() ? copies : -1;
+    }();
+    static_assert( copies_on_lvalue_path > 0 );
+    std::cout << "copies on the lvalue path: " << copies_on_lvalue_path << std::endl;
+
+    auto w = create_struct( make_member<"payload">( std::string( 1024, 'x' ) ) );
+    char const* buffer = w.read<"payload">().data();
+    auto x = std::move(w).update<"tail">( 1 );
+    check( buffer == x.read<"payload">().data(), "payload moved" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// storage
+void test_storage()
+{
+    std::cout << std::endl << "test STORAGE" << std::endl;
+    using namespace meta;
+
+    auto constexpr s = create_struct( make_member<"one">( 1 ), make_member<"two">( 2UL ), make_member<"three">( 3.0f ) );
+    using S = std::remove_cvref_t<decltype(s)>;
+    static_assert( std::is_standard_layout_v<S> );
+    static_assert( std::is_trivially_copyable_v<S> );
+    static_assert( offsetof( S, s_.m2 ) == 16 );
+
+    S copied[2];
+    std::memcpy( copied, &s, sizeof(S) );
+    std::memcpy( copied + 1, &s, sizeof(S) );
+    std::cout << "sizeof: " << sizeof(S) << ", stride: " << reinterpret_cast<char const*>(copied + 1) - reinterpret_cast<char const*>(copied) << std::endl;
+    check( copied[1].read<"three">() == 3.0f, "memcpy'd structure readable" );
+
+    auto constexpr t = create_struct( make_member<"0">( 0 ), make_member<"1">( 1 ), make_member<"2">( 2 ), make_member<"3">( 3 ), make_member<"4">( 4 ),
+                                      make_member<"5">( 5 ), make_member<"6">( 6 ), make_member<"7">( 7 ), make_member<"8">( 8 ), make_member<"9">( 9 ) );
+    static_assert( sizeof(t) == 10 * sizeof(int) );
+    static_assert( read_struct<"9">( t ) == 9 );
+    static_assert( read_struct<"9">( update_struct<"9">( t, 10 ) ) == 10 );
+    static_assert( !struct_has<"8">( delete_struct<"8">( t ) ) );
+
+    auto w = create_struct( make_member<"name">( std::string{"meta"} ) );
+    static_assert( !std::is_trivially_copyable_v<decltype(w)> );
+    std::cout << "---------------------------------------------------------\n";
+}
+// pack
+void test_pack()
+{
+    std::cout << std::endl << "test PACK" << std::endl;
+    using namespace meta;
+
+    auto constexpr s = create_struct( make_member<"a">( 'a' ), make_member<"b">( 1.0 ), make_member<"c">( 'c' ) );
+    auto constexpr t = pack_struct( s );
+    auto constexpr u = s.packed();
+    using T = std::remove_cvref_t<decltype(t)>;
+
+    constexpr auto ls = layout_of( s );
+    constexpr auto lt = layout_of( t );
+    static_assert( ls.size == 24 && ls.padding == 14 && ls.offset_of( "c" ) == 16 );
+    static_assert( lt.size == 16 && lt.padding == 6 && lt.offset_of( "b" ) == 0 );
+    static_assert( lt.offset_of( "a" ) == offsetof( T, s_.m1 ) && lt.offset_of( "c" ) == offsetof( T, s_.m2 ) );
+    static_assert( offset_of<"c">( s ) == 16 && offset_of<"a", T>() == offsetof( T, s_.m1 ) );
+    // an unknown tag is rejected, at compile time by `offset_of<tag_>`
+    bool unknown_rejected = false;
+    try { ( void )layout_of( s ).offset_of( "d" ); }
+    catch ( std::out_of_range const& ) { unknown_rejected = true; }
+    check( unknown_rejected, "unknown tag rejected" );
+    static_assert( std::is_same_v<decltype(t), decltype(u)> );
+    static_assert( read_struct<"a">( t ) == 'a' && read_struct<"b">( t ) == 1.0 && read_struct<"c">( t ) == 'c' );
+
+    auto constexpr w = create_struct( make_member<"0">( 'x' ), make_member<"1">( 1.0 ), make_member<"2">( 'x' ), make_member<"3">( 1 ), make_member<"4">( 'x' ),
+                                      make_member<"5">( 1.0 ), make_member<"6">( short{1} ), make_member<"7">( 1 ), make_member<"8">( 'x' ), make_member<"9">( 1.0 ) );
+    static_assert( layout_of( w ).size == sizeof(w) );
+    static_assert( layout_of( pack_struct( w ) ).padding < layout_of( w ).padding );
+
+    for ( auto const& l : { layout_of( s ), layout_of( t ) } )
+    {
+        std::cout << "sizeof: " << l.size << ", padding: " << l.padding << ", offsets:";
+        for ( std::size_t index = 0; index < l.tags.size(); ++index )
+            std::cout << " " << l.tags[index] << "@" << l.offsets[index];
+        std::cout << std::endl;
+    }
+    std::cout << "---------------------------------------------------------\n";
+}
+// counts its instances, and its copies throw once `budget` copies are made
+struct fragile
+{
+    static inline int live = 0;
+    static inline int budget = 0;
+
+    fragile() noexcept { ++live; }
+    fragile( fragile const& ) { if ( budget-- <= 0 ) throw std::runtime_error{ "fragile" }; ++live; }
+    fragile( fragile&& other ) : fragile( static_cast<fragile const&>( other ) ) {}
+    fragile& operator = ( fragile const& ) = default;
+    fragile& operator = ( fragile&& ) { return *this; }
+    ~fragile() { --live; }
+};
+
+// soa_vector
+void test_soa_vector()
+{
+    std::cout << std::endl << "test SOA_VECTOR" << std::endl;
+    using namespace meta;
+
+    auto const prototype = create_struct( make_member<"x">( 0.0f ), make_member<"id">( 0 ), make_member<"name">( std::string{} ) );
+    soa_vector v{ prototype };
+    v.reserve( 4 );
+    for ( int index = 0; index < 10; ++index )
+        v.push_back( prototype.update<"x">( index * 0.5f ).update<"id">( index ).update<"name">( std::to_string( index ) ) );
+
+    float sum = 0.0f;
+    for ( float x : v.col<"x">() )
+        sum += x;
+    std::cout << "size: " << v.size() << ", sum of x: " << sum << std::endl;
+    check( v.size() == 10 && sum == 22.5f, "pushed rows summed" );
+    check( reinterpret_cast<std::uintptr_t>( v.col<"x">().data() ) % decltype(v)::column_alignment == 0, "x column aligned" );
+
+    v[3].update<"id">( 33 ).update<"name">( std::string{"thirty-three"} );
+    check( v[3].read<"id">() == 33 && v[3].read<"name">() == "thirty-three" && !v[3].has<"z">(), "row 3 updated in place" );
+
+    v.erase( 0, 2 );
+    v.erase( 5 );
+    auto const& cv = v;
+    std::cout << "after erase:";
+    for ( std::size_t index = 0; index < cv.size(); ++index )
+        std::cout << " " << cv[index].read<"name">();
+    std::cout << std::endl;
+
+    auto copied = v;
+    decltype(prototype) row = copied[1];
+    check( row.read<"id">() == 33 && row.read<"name">() == "thirty-three", "row 1 converted to a structure" );
+
+    map_columns( v, []<Member M>( M const& m ) requires std::is_arithmetic_v<typename M::value_type> { return m.value() * 2; } );
+    std::cout << "after map_columns:";
+    for ( std::size_t index = 0; index < v.size(); ++index )
+        std::cout << " " << v[index].read<"name">() << "/" << v[index].read<"id">() << "/" << v[index].read<"x">();
+    std::cout << std::endl;
+
+    // a callable taking the SIMD members too: the full vectors are mapped by SIMD, the remainder by the scalar loop, to the same values
+    std::size_t vector_calls = 0;
+    auto const affine = [&]<Member M>( M const& m ) requires ( !std::is_same_v<typename M::value_type, std::string> )
+    {
+        using value_type = typename M::value_type;
+        if constexpr ( !std::is_arithmetic_v<value_type> ) ++vector_calls;
+        return m.value() * value_type( 3 ) + value_type( 1 );
+    };
+    auto const wide = create_struct( make_member<"x">( 0.0f ), make_member<"id">( 0 ), make_member<"w">( 0.0 ), make_member<"name">( std::string{} ) );
+    soa_vector columns{ wide };
+    std::size_t const rows = 37;  // not a multiple of any vector size
+    for ( std::size_t index = 0; index < rows; ++index )
+        columns.push_back( wide.update<"x">( index * 0.25f - 2.0f ).update<"id">( int( index ) - 5 ).update<"w">( index * 1.5 ).update<"name">( std::to_string( index ) ) );
+    soa_vector const before = columns;
+    map_columns( columns, affine );
+    bool same = true;
+    for ( std::size_t index = 0; index < rows; ++index )
+    {
+        same = same && columns[index].read<"x">() == affine( make_member<"x">( before[index].read<"x">() ) );
+        same = same && columns[index].read<"id">() == affine( make_member<"id">( before[index].read<"id">() ) );
+        same = same && columns[index].read<"w">() == affine( make_member<"w">( before[index].read<"w">() ) );
+        same = same && columns[index].read<"name">() == std::to_string( index );
+    }
+    check( same, "SIMD and scalar agree" );
+#ifdef META_STRUCTURE_HAS_SIMD
+    check( vector_calls > 0, "SIMD used" );
+#endif
+
+    // a field whose copy throws once its budget is spent: a failed push_back or growth leaves the vector as it was, and leaks nothing
+    fragile::live = 0;
+    {
+        fragile::budget = 100;
+        auto const sample = create_struct( make_member<"id">( 1 ), make_member<"a">( fragile{} ), make_member<"b">( fragile{} ) );
+        soa_vector rows{ sample };
+        rows.reserve( 8 );
+        for ( int index = 0; index != 7; ++index )
+            rows.push_back( sample );
+        int const before = fragile::live;
+        fragile::budget = 1;  // the copy of "a" succeeds, that of "b" throws
+        bool const push_thrown = [&]() { try { rows.push_back( sample ); } catch ( std::runtime_error const& ) { return true; } return false; }();
+        bool const push_intact = rows.size() == 7 && rows.capacity() == 8 && fragile::live == before;
+        fragile::budget = 3;  // growing copies the rows, as the move of `fragile` may throw
+        bool const grow_thrown = [&]() { try { rows.reserve( 64 ); } catch ( std::runtime_error const& ) { return true; } return false; }();
+        bool const grow_intact = rows.size() == 7 && rows.capacity() == 8 && fragile::live == before && rows[6].read<"id">() == 1;
+        fragile::budget = 100;
+        rows.resize( 4 );
+        check( push_thrown && push_intact, "failed push_back leaves the vector as it was" );
+        check( grow_thrown && grow_intact, "failed reserve leaves the vector as it was" );
+        check( !noexcept( rows.erase( 0 ) ) && noexcept( columns.erase( 0 ) ), "erase noexcept when the moves are" );
+    }
+    check( fragile::live == 0, "no fragile field leaked" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// a tag "f000", "f001", ... for the I-th field
+template< std::size_t I >
+constexpr auto numbered_tag() noexcept
+{
+    char const name[5] = { 'f', char( '0' + I / 100 % 10 ), char( '0' + I / 10 % 10 ), char( '0' + I % 10 ), '\0' };
+    return meta::fixed_string<4>{ name };
+}
+
+template< std::size_t ... Is >
+constexpr auto create_wide_struct( std::index_sequence<Is...> ) noexcept
+{
+    return meta::create_struct( meta::make_member<numbered_tag<Is>()>( int(Is) )... );
+}
+
+// wide
+void test_wide()
+{
+    std::cout << std::endl << "test WIDE" << std::endl;
+    using namespace meta;
+
+    auto const s = create_wide_struct( std::make_index_sequence<1000>{} );
+    using S = std::remove_cvref_t<decltype(s)>;
+    static_assert( S::size() == 1000 && struct_has<"f999">( S{} ) && !struct_has<"f1000">( S{} ) );
+    static_assert( layout_of( s ).size == sizeof(S) && layout_of( s ).offset_of( "f999" ) == 999 * sizeof(int) );
+
+    // instantiated only, the generated code of 1000-argument functions is slow to optimize
+    using T = decltype( update_struct<"f999">( s, 1.0 ) );
+    using U = decltype( delete_struct<"f500">( std::declval<T>() ) );
+    using V = decltype( upgrade_struct<"f001">( std::declval<U>(), 1 ) );
+    using W = decltype( map_struct( std::declval<V>(), []<Member M>( M const& m ) { return m.value() + 1; } ) );
+    using X = decltype( concatenate_struct( std::declval<W>(), create_struct( make_member<"extra">( 1 ) ), create_struct( make_member<"more">( 2 ) ) ) );
+    static_assert( std::is_same_v<decltype(X{}.read<"f999">()), double const&> && !struct_has<"f500">( X{} ) && X::size() == 1001 );
+
+    auto const t = update_struct<"f999">( s, 1.0 );
+    check( t.size() == 1000 && t.read<"f000">() == 0 && t.read<"f500">() == 500 && t.read<"f999">() == 1.0, "wide structure updated" );
+    std::cout << "---------------------------------------------------------\n";
+}
+
+template< std::size_t ... Is >
+constexpr bool finds_every_tag( std::index_sequence<Is...> ) noexcept
+{
+    constexpr auto table = meta::detail::tag_table_v<numbered_tag<Is>()...>;
+    return !table.duplicate && !table.collision && ( ( table.find( numbered_tag<Is>().view(), numbered_tag<Is>().hash() ) == Is ) && ... );
+}
 
+// tag
+void test_tag()
+{
+    std::cout << std::endl << "test TAG" << std::endl;
+    using namespace meta;
+
+    constexpr fixed_string<2> ab{ "ab" };
+    constexpr fixed_string<3> ab0{ { 'a', 'b', '\0', '\0' } };
+    static_assert( ab == ab0 && !( ab == fixed_string{ "abc" } ) && !( ab == fixed_string{ "ba" } ) );
+    static_assert( ( ab <=> ab0 ) == 0 && ab < fixed_string{ "abc" } && fixed_string{ "ba" } > ab && ab <= ab0 );
+    static_assert( ab.hash() == ab0.hash() && ab.hash() == detail::fnv1a( "ab" ) );
+
+    constexpr auto table = detail::tag_table_v<"one", "two", "three">;
+    static_assert( table.find( "two", fixed_string{ "two" }.hash() ) == 1 && table.find( "four", fixed_string{ "four" }.hash() ) == 3 );
+    static_assert( !table.duplicate && detail::tag_table_v<"one", "two", "one">.duplicate );
+    static_assert( finds_every_tag( std::make_index_sequence<1000>{} ) );
+
+    std::cout << "hash of \"ab\": " << std::hex << ab.hash() << std::dec << std::endl;
+    std::cout << "---------------------------------------------------------\n";
+}
+
+// visit
+void test_visit()
+{
+    std::cout << std::endl << "test VISIT" << std::endl;
+    using namespace meta;
+
+    auto constexpr s = create_struct( make_member<"one">( 1 ), make_member<"two">( 2UL ), make_member<"three">( 3.0f ) );
+    static_assert( struct_has( s, "two" ) && !struct_has( s, "four" ) && s.has( std::string_view{ "three" } ) );
+    static_assert( [&]() { double sum = 0; s.visit( "three", [&]( auto const& member ) { sum += member.value(); } ); return sum; }() == 3.0 );
+
+    for ( std::string const name : { "one", "two", "three", "four" } )
+    {
+        bool const found = visit_field( s, name, []<Member M>( M const& member ) { std::cout << static_cast<std::string>(M::tag()) << ": " << member.value() << std::endl; } );
+        check( found == ( name != "four" ), name + ( found ? " found" : " not found" ) );
+    }
+    std::cout << "---------------------------------------------------------\n";
+}
+
+// update_fields, delete_fields
+void test_fields()
+{
+    std::cout << std::endl << "test UPDATE_FIELDS/DELETE_FIELDS" << std::endl;
+    using namespace meta;
+
+    auto constexpr s = create_struct( make_member<"one">( 1 ), make_member<"two">( 2UL ), make_member<"three">( 3.0f ) );
+    auto constexpr t = update_fields( s, make_member<"three">( 'c' ), make_member<"four">( 4.0 ), make_member<"one">( -1 ), make_member<"five">( 5 ) );
+    static_assert( t.size() == 5 && t.read<"one">() == -1 && t.read<"two">() == 2UL && t.read<"three">() == 'c' && t.read<"four">() == 4.0 && t.read<"five">() == 5 );
+    static_assert( std::is_same_v<std::remove_cvref_t<decltype(t)>, decltype(s.update<"three">( 'c' ).update<"four">( 4.0 ).update<"one">( -1 ).update<"five">( 5 ))> );
+    static_assert( std::is_same_v<decltype(update_fields( s )), std::remove_cvref_t<decltype(s)>> );
+
+    auto constexpr u = delete_fields<"three", "zero", "one">( t );
+    static_assert( u.size() == 3 && u.read<"two">() == 2UL && u.read<"four">() == 4.0 && !u.has<"one">() && !u.has<"three">() );
+    static_assert( std::is_same_v<decltype(delete_fields<>( s )), std::remove_cvref_t<decltype(s)>> );
+    //auto constexpr v = delete_fields<"one", "one">( t ); // <-- does not compile: a tag is deleted more than once
+
+    // every field kept is copied once from an lvalue, moved from an rvalue
+    int copies = 0;
+    auto w = create_struct( make_member<"a">( counted{&copies} ), make_member<"b">( counted{&copies} ), make_member<"c">( counted{&copies} ) );
+    auto const x = update_fields( w, make_member<"b">( 1 ), make_member<"d">( counted{&copies} ) );
+    check( copies == 2, "update_fields copies a and c once" );
+    auto const y = delete_fields<"a", "d">( x );
+    check( copies == 3 && y.size() == 2, "delete_fields copies c once" );
+    auto const z = delete_fields<"a">( std::move( w ) );
+    check( copies == 3 && z.size() == 2, "delete_fields moves from an rvalue" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// lazy
+void test_lazy()
+{
+    std::cout << std::endl << "test LAZY" << std::endl;
+    using namespace meta;
+
+    // the chain refers to `s`, which has to be static for `l` to be constexpr
+    static auto constexpr s = create_struct( make_member<"one">( 1 ), make_member<"two">( 2UL ), make_member<"three">( 3.0f ) );
+    auto constexpr l = s.lazy().update<"one">( 1.5 ).destroy<"two">().add<"four">( 4 ).update<"five">( 'x' ).destroy<"five">();
+    static_assert( l.size() == 3 && l.read<"one">() == 1.5 && l.read<"three">() == 3.0f && !l.has<"two">() && !l.has<"five">() );
+
+    auto constexpr t = l.materialize();
+    auto constexpr e = s.update<"one">( 1.5 ).destroy<"two">().add<"four">( 4 ).update<"five">( 'x' ).destroy<"five">();
+    static_assert( std::is_same_v<decltype(t), decltype(e)> && t.read<"one">() == e.read<"one">() && t.read<"four">() == e.read<"four">() );
+
+    // upgrades, to the same type and to another one
+    auto const f = create_struct( make_member<"f">( []( int x ) { return x; } ), make_member<"g">( 1 ) );
+    auto const u = f.lazy().upgrade<"f">( []( double x ) { return 2 * x; } ).upgrade<"g">( 2 ).upgrade<"h">( 3 ).materialize();
+    auto const v = f.upgrade<"f">( []( double x ) { return 2 * x; } ).upgrade<"g">( 2 ).upgrade<"h">( 3 );
+    static_assert( u.size() == 3 && std::is_same_v<decltype(u.read<"g">()), decltype(v.read<"g">())> );
+    check( u.read<"f">()( 1 ) == 1 && u.read<"f">()( 1.5 ) == 3.0 && u.read<"g">() == 2 && u.read<"h">() == 3, "upgraded lazily" );
+
+    // converted to a structure once, the strings moved
+    auto w = create_struct( make_member<"a">( std::string( 64, 'a' ) ), make_member<"b">( std::string( 64, 'b' ) ) );
+    decltype( w.update<"a">( std::string{} ).add<"c">( 1 ) ) const x = std::move( w ).lazy().update<"a">( std::string( 64, 'x' ) ).add<"c">( 3 );
+    check( x.read<"a">() == std::string( 64, 'x' ) && x.read<"b">() == std::string( 64, 'b' ) && x.read<"c">() == 3, "chain converted to a structure" );
+
+    // the value of an update deleted or updated again is not kept in the chain, nor copied by the next links
+    std::array<char, 1024> const big{};
+    static_assert( sizeof( s.lazy().update<"two">( big ).destroy<"two">() ) == sizeof( s.lazy().destroy<"two">() ) );
+    static_assert( sizeof( s.lazy().update<"two">( big ).update<"two">( 2UL ) ) == sizeof( s.lazy().update<"two">( 2UL ) ) );
+    static_assert( sizeof( f.lazy().upgrade<"f">( [big]( double ) { return big[0]; } ).upgrade<"f">( []( char c ) { return c; } ).destroy<"f">() ) == sizeof( f.lazy().destroy<"f">() ) );
+    constexpr auto copies_of_folded = []()
+    {
+        int copies = 0;
+        auto const l = s.lazy().update<"one">( counted{&copies} );
+        auto const m = l.destroy<"one">();
+        auto const n = m.add<"four">( 4 ).add<"five">( 5 );
+        return n.has<"one">() ? -1 : copies;
+    }();
+    static_assert( copies_of_folded == 0 );
+    std::cout << "---------------------------------------------------------\n";
+}
+// ref, set, emplace
+void test_mutable()
+{
+    std::cout << std::endl << "test REF/SET/EMPLACE" << std::endl;
+    using namespace meta;
+
+    auto s = create_struct( make_member<"count">( 0L ), make_member<"sum">( 0.0 ), make_member<"buffer">( std::vector<int>{} ), make_member<"name">( std::string{} ) );
+    static_assert( std::is_same_v<decltype(s.ref<"count">()), long&> && std::is_same_v<decltype(std::as_const( s ).ref<"count">()), long const&> );
+
+    auto& buffer = s.ref<"buffer">();
+    for ( int index = 0; index < 10; ++index )
+    {
+        ++s.ref<"count">();
+        s.ref<"sum">() += index;
+        buffer.push_back( index );
+    }
+    s.set<"sum">( s.read<"sum">() / 2 ).set<"count">( 100 ).emplace<"name">( 3, 'z' );
+    check( s.read<"count">() == 100 && s.read<"sum">() == 22.5 && s.read<"buffer">().size() == 10 && s.read<"name">() == "zzz", "fields modified in place" );
+
+    // a type-changing update still returns a new structure
+    auto const t = s.update<"count">( std::string{ "many" } );
+    check( t.read<"count">() == "many" && s.read<"count">() == 100, "type-changing update copied" );
+
+    static_assert( []() { auto c = create_struct( make_member<"n">( 1 ) ); c.ref<"n">() += 41; return c.read<"n">(); }() == 42 );
+    std::cout << "---------------------------------------------------------\n";
+}
+// fold
+void test_fold()
+{
+    std::cout << std::endl << "test FOR_EACH/FOLD/FILTER/TRANSFORM_IF" << std::endl;
+    using namespace meta;
+
+    auto const s = create_struct( make_member<"id">( 7 ), make_member<"name">( std::string{"meta"} ), make_member<"weight">( 1.5 ), make_member<"count">( 3L ) );
+    s.for_each_field( []<Member M>( M const& member ) { std::cout << static_cast<std::string>(M::tag()) << ": " << member.value() << std::endl; } );
+
+    auto const numbers = filter_struct<std::is_arithmetic>( s );
+    static_assert( numbers.size() == 3 && !numbers.has<"name">() );
+    double const sum = fold_struct( numbers, 0.0, []<Member M>( double acc, M const& member ) { return acc + member.value(); } );
+    check( sum == 11.5, "numbers summed" );
+
+    std::size_t const characters = s.fold( std::size_t{0}, []<Member M>( std::size_t acc, M const& member )
+    {
+        if constexpr ( std::is_same_v<typename M::value_type, std::string> ) return acc + member.value().size();
+        else return acc;
+    } );
+    check( characters == 4, "characters counted" );
+
+    auto const doubled = transform_if<std::is_integral>( s, []<Member M>( M const& member ) { return member.value() * 2; } );
+    check( doubled.read<"id">() == 14 && doubled.read<"count">() == 6 && doubled.read<"weight">() == 1.5 && doubled.read<"name">() == "meta", "integers doubled" );
+
+    static_assert( fold_struct( create_struct( make_member<"a">( 1 ), make_member<"b">( 2 ), make_member<"c">( 3 ) ), 0, []<Member M>( int acc, M const& member ) { return acc * 10 + member.value(); } ) == 123 );
+
+    // an exception thrown by the visitor propagates to the caller
+    auto const throwing = []<Member M>( M const& ) { if constexpr ( M::tag() == fixed_string{"weight"} ) throw std::runtime_error{ "weight" }; };
+    auto const throwing_fold = [&]<Member M>( int acc, M const& member ) { throwing( member ); return acc + 1; };
+    auto const throws = []( auto&& visit ) { try { visit(); } catch ( std::runtime_error const& ) { return true; } return false; };
+    static_assert( noexcept( s( []<Member ... MS>( MS const& ... ) noexcept {} ) ) && !noexcept( s( []<Member ... MS>( MS const& ... ) {} ) ) );
+    bool const propagated = throws( [&]() { for_each_field( s, throwing ); } ) && throws( [&]() { s.for_each_field( throwing ); } ) &&
+                            throws( [&]() { fold_struct( s, 0, throwing_fold ); } ) && throws( [&]() { s.fold( 0, throwing_fold ); } );
+    check( propagated, "exceptions propagated" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// parallel
+void test_parallel()
+{
+    std::cout << std::endl << "test PARALLEL_MAP" << std::endl;
+    using namespace meta;
+
+    auto const s = create_struct( make_member<"left">( std::vector<double>( 100000, 1.0 ) ), make_member<"right">( std::vector<double>( 200000, 2.0 ) ),
+                                  make_member<"scale">( 3 ) );
+    auto const sum = []<Member M>( M const& member )
+    {
+        if constexpr ( std::is_arithmetic_v<typename M::value_type> ) return static_cast<double>( member.value() );
+        else return std::accumulate( member.value().begin(), member.value().end(), 0.0 );
+    };
+
+    thread_pool pool{ 2 };
+    auto const t = parallel_map_struct( s, sum, pool );
+    auto const u = map_struct( s, sum );
+    check( t.read<"left">() == u.read<"left">() && t.read<"right">() == u.read<"right">() && t.read<"scale">() == u.read<"scale">(), "parallel_map_struct matches map_struct" );
+
+    // a task mapping another structure on the same single worker does not block it
+    thread_pool single{ 1 };
+    auto const nested = parallel_map_struct( create_struct( make_member<"outer">( std::vector<int>( 5000, 1 ) ) ), [&]<Member M>( M const& member )
+    {
+        auto const inner = parallel_map_struct( create_struct( make_member<"inner">( member.value() ) ), []<Member N>( N const& n ) { return n.value().size(); }, single );
+        return inner.template read<"inner">();
+    }, single );
+    check( nested.read<"outer">() == 5000, "nested map on a single worker" );
+
+    // any type with `execute` is an executor, this one runs the tasks at once
+    struct inline_executor { void execute( std::function<void()> task ) { task(); } } executor;
+    auto const v = parallel_map_struct( s, sum, executor, parallel_options{ .min_cost = 0 } );
+    check( v.read<"right">() == 400000, "inline executor" );
+
+    // an exception of a task, of an inline field or of the executor is rethrown once the submitted tasks are done
+    std::atomic<int> finished = 0;
+    auto const throwing = [&]<Member M>( M const& member )
+    {
+        if constexpr ( M::tag() == fixed_string{"right"} ) throw std::runtime_error{ "right" };
+        else if constexpr ( M::tag() == fixed_string{"scale"} ) { if ( member.value() == 3 ) throw std::runtime_error{ "scale" }; }
+        double const ans = sum( member );
+        ++finished;
+        return ans;
+    };
+    auto const rethrown = [&]( auto&& ... args ) -> std::string
+    {
+        try { parallel_map_struct( s, throwing, args... ); }
+        catch ( std::exception const& e ) { return e.what(); }
+        return "nothing";
+    };
+    struct failing_executor
+    {
+        thread_pool* pool;
+        int calls = 0;
+        void execute( std::function<void()> task ) { if ( ++calls == 2 ) throw std::runtime_error{ "executor" }; pool->execute( std::move( task ) ); }
+    } failing{ &pool };
+    std::string const first = rethrown( pool );
+    int const left_done = finished.exchange( 0 );
+    std::string const second = rethrown( failing );
+    check( ( first == "right" || first == "scale" ) && left_done == 1, "exception of a task or an inline field rethrown" );
+    check( second == "executor" && finished == 1, "exception of the executor rethrown" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// atomic
+void test_atomic()
+{
+    std::cout << std::endl << "test ATOMIC_STRUCT" << std::endl;
+    using namespace meta;
+
+    atomic_struct config{ create_struct( make_member<"threads">( 8 ), make_member<"model">( std::vector<double>( 1000, 0.5 ) ), make_member<"name">( std::string{"v1"} ) ) };
+    //atomic_struct cached{ create_struct( make_member<"name">( std::string{} ), make_computed_member<"length", "name">( []( std::string const& n ) { return n.size(); } ) ) }; // <-- does not compile: computed members are not shared
+    {
+        auto const before = config.snapshot();
+        double const* model = before.read<"model">().data();
+        config.publish( make_member<"threads">( 16 ), make_member<"name">( "v16" ) );
+        auto const after = config.snapshot();
+        check( before.read<"threads">() == 8 && after.read<"threads">() == 16 && after.read<"name">() == "v16", "old version kept" );
+        check( after.read<"model">().data() == model, "untouched field shared" );
+    }
+
+    // readers always see a consistent version while the writer publishes
+    std::atomic<bool> torn{ false };
+    {
+        std::vector<std::jthread> readers;
+        for ( int index = 0; index < 4; ++index )
+            readers.emplace_back( [&]()
+            {
+                for ( int round = 0; round < 20000; ++round )
+                {
+                    auto const s = config.snapshot();
+                    if ( s.read<"name">() != "v" + std::to_string( s.read<"threads">() ) ) torn = true;
+                }
+            } );
+        for ( int threads = 17; threads < 2000; ++threads )
+            config.publish( make_member<"threads">( threads ), make_member<"name">( "v" + std::to_string( threads ) ) );
+    }
+    check( !torn && config.load().read<"threads">() == 1999, "readers saw consistent versions" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// any
+void test_any()
+{
+    std::cout << std::endl << "test ANY_STRUCT" << std::endl;
+    using namespace meta;
+
+    using shape = interface<method<"area", double()>, method<"scale", double(double)>, property<"name", std::string>>;
+    auto const square = create_struct( make_member<"area">( []() { return 1.0; } ), make_member<"scale">( []( double x ) { return x * x; } ),
+                                       make_member<"name">( std::string{"square"} ) );
+    // a derived shape, larger than the buffer and stored on the heap
+    auto const circle = update_struct<"name">( update_struct<"area">( square, [r = 2.0, pad = std::array<double, 8>{}]() { return 3.14159 * r * r + pad[0]; } ), std::string{"circle"} );
+    static_assert( implements_v<std::remove_cvref_t<decltype(circle)>, shape> );
+    static_assert( !implements_v<decltype(create_struct( make_member<"area">( 1.0 ) )), shape> );
+
+    std::vector<any_struct<shape>> shapes;
+    shapes.emplace_back( square );
+    shapes.emplace_back( circle );
+    shapes.push_back( shapes[1] );
+    shapes.erase( shapes.begin() + 1 );
+    for ( auto const& s : shapes )
+        std::cout << s.read<"name">() << ": area " << s.call<"area">() << ", scaled by 3 " << s.call<"scale">( 3 ) << std::endl;
+    check( shapes.size() == 2 && shapes[1].read<"name">() == "circle" && shapes[1].call<"scale">( 3 ) == 9.0, "shapes copied and erased" );
+
+    any_struct<shape> moved = std::move( shapes[1] );
+    check( !shapes[1] && moved && moved.read<"name">() == "circle", "any_struct moved" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// computed
+void test_computed()
+{
+    std::cout << std::endl << "test COMPUTED MEMBERS" << std::endl;
+    using namespace meta;
+
+    static int checksums = 0;
+    auto s = create_struct( make_member<"name">( std::string{"Meta"} ), make_member<"data">( std::vector<int>{ 1, 2, 3 } ),
+                            make_computed_member<"key", "name">( []( std::string const& name ) { std::string key = name; for ( char& c : key ) c = std::tolower( c ); return key; } ),
+                            make_computed_member<"checksum", "data">( []( std::vector<int> const& data ) { ++checksums; return std::accumulate( data.begin(), data.end(), 0 ); } ) );
+
+    // never read, never computed
+    auto const unread = update_struct<"data">( update_struct<"data">( s, std::vector<int>{ 4 } ), std::vector<int>{ 5, 6 } );
+    check( checksums == 0, "nothing computed before a read" );
+
+    check( s.read<"key">() == "meta" && s.read<"checksum">() == 6 && s.read<"checksum">() == 6 && checksums == 1, "computed once" );
+    auto const renamed = update_struct<"name">( s, std::string{"STRUCTURE"} );
+    check( renamed.read<"key">() == "structure" && renamed.read<"checksum">() == 6 && checksums == 1, "cache kept when another field is updated" );
+    auto const refilled = update_fields( s, make_member<"data">( std::vector<int>{ 10, 20 } ) );
+    check( refilled.read<"checksum">() == 30 && checksums == 2, "recomputed after update_fields" );
+    s.ref<"data">().push_back( 4 );
+    check( s.read<"checksum">() == 10 && checksums == 3, "recomputed after ref" );
+    auto const chained = s.lazy().update<"data">( std::vector<int>{ 7 } ).materialize();
+    check( chained.read<"checksum">() == 7 && unread.read<"checksum">() == 11 && checksums == 5, "recomputed after a lazy chain" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// patch
+void test_patch()
+{
+    std::cout << std::endl << "test DIFF/PATCH" << std::endl;
+    using namespace meta;
+
+    auto const before = create_struct( make_member<"id">( 42 ), make_member<"price">( 9.5 ), make_member<"name">( std::string{"meta"} ),
+                                       make_member<"history">( std::vector<int>{ 1, 2, 3 } ),
+                                       make_computed_member<"label", "name">( []( std::string const& name ) { return name + "!"; } ),
+                                       make_member<"flag">( 'n' ) );
+    auto const after = before.update<"price">( 10.25 ).update<"history">( std::vector<int>{ 1, 2, 3, 4 } );
+    static_assert( std::is_same_v<decltype(before), decltype(after)> );
+
+    auto const patch = diff_struct( before, after );
+    check( patch.count() == 2 && patch.changed<"price">() && patch.changed<"history">() && !patch.changed<"name">(), "changed fields found" );
+    std::vector<std::byte> const message = serialize_patch( patch );
+    std::cout << "patch of " << message.size() << " bytes, the structure takes " << serialize_struct( delete_struct<"label">( after ) ).size() << std::endl;
+
+    auto const received = deserialize_patch<std::remove_cvref_t<decltype(before)>>( std::span{ message } );
+    check( received && received->count() == 2, "patch deserialized" );
+    auto const replica = apply_patch( before, *received );
+    check( diff_struct( replica, after ).empty() && replica.read<"price">() == 10.25, "replica matches the original" );
+
+    // doubles are compared by value: 0.0 and -0.0 are equal, a NaN differs from itself
+    bool const signed_zero = diff_struct( before.update<"price">( 0.0 ), before.update<"price">( -0.0 ) ).empty();
+    auto const nan = before.update<"price">( std::numeric_limits<double>::quiet_NaN() );
+    check( signed_zero && diff_struct( nan, nan ).changed<"price">(), "doubles compared by value" );
+
+    // an assignment which throws propagates out of apply_to, the fields before it are assigned
+    auto target = create_struct( make_member<"id">( 1 ), make_member<"text">( std::pmr::string( std::pmr::null_memory_resource() ) ) );
+    struct_patch<std::remove_cvref_t<decltype(target)>> failing;
+    failing.set<"id">( 2 ).set<"text">( std::pmr::string( 200, 't' ) );
+    auto const throws_bad_alloc = []( auto&& apply ) { try { apply(); } catch ( std::bad_alloc const& ) { return true; } return false; };
+    bool const apply_throws = throws_bad_alloc( [&]() { failing.apply_to( target ); } ) && throws_bad_alloc( [&]() { std::move( failing ).apply_to( target ); } );
+    check( apply_throws && target.read<"id">() == 2 && target.read<"text">().empty(), "failed assignment propagated" );
+
+    // a renamed structure recomputes the label
+    auto const renamed = apply_patch( replica, struct_patch<std::remove_cvref_t<decltype(before)>>{}.set<"name">( std::string{"structure"} ) );
+    check( replica.read<"label">() == "meta!" && renamed.read<"label">() == "structure!", "label recomputed" );
+
+    // a truncated message, or another schema, is rejected
+    bool const truncated = deserialize_patch<std::remove_cvref_t<decltype(before)>>( std::span{ message }.first( message.size() - 1 ) ).has_value();
+    bool const other = deserialize_patch<decltype(create_struct( make_member<"id">( 42 ) ))>( std::span{ message } ).has_value();
+    check( !truncated && !other, "truncated message and other schema rejected" );
+    std::cout << "---------------------------------------------------------\n";
+}
+void test_compare()
+{
+    std::cout << std::endl << "test COMPARE/HASH" << std::endl;
+    using namespace meta;
+
+    auto const point = []( int x, int y, std::string name, double weight )
+    {
+        return create_struct( make_member<"x">( x ), make_member<"y">( y ), make_member<"name">( std::move( name ) ), make_member<"weight">( weight ),
+                              make_computed_member<"label", "name">( []( std::string const& n ) { return n + "!"; } ) );
+    };
+    auto const a = point( 1, 2, "a", 0.5 );
+    auto const b = point( 1, 2, "b", 0.5 );
+    auto const c = point( 1, 3, "a", -0.0 );
+    check( a == point( 1, 2, "a", 0.5 ) && a != b && a < b && b < c, "compared field by field" );
+    // a cached label is not compared
+    check( a.read<"label">() == "a!" && a == point( 1, 2, "a", 0.5 ), "cached label not compared" );
+    // doubles are compared by value, not by bytes
+    check( point( 1, 3, "a", 0.0 ) == c, "0.0 == -0.0" );
+
+    constexpr auto p = create_struct( make_member<"x">( 1 ), make_member<"y">( 2 ), make_member<"z">( 'z' ) );
+    static_assert( p == p.update<"z">( 'z' ) && p != p.update<"y">( 3 ) && p < p.update<"y">( 3 ) );
+
+    std::vector<std::remove_cvref_t<decltype(a)>> points{ c, b, a };
+    std::sort( points.begin(), points.end() );
+    check( points[0] == a && points[1] == b && points[2] == c, "sorted" );
+
+    std::unordered_map<std::remove_cvref_t<decltype(a)>, int> counts;
+    for ( int index = 0; index != 1000; ++index )
+        ++counts[point( index % 10, index % 7, std::string( index % 3, 'n' ), 0.25 * ( index % 2 ) )];
+    check( counts.size() == 210 && hash_struct( a ) == hash_struct( point( 1, 2, "a", 0.5 ) ) && hash_struct( a ) != hash_struct( b ), "hashed by value" );
+
+    // a view is compared and hashed by what it refers to, not by its pointer
+    std::string const first{ "view" }, second{ "view" };
+    auto const v = create_struct( make_member<"id">( 1 ), make_member<"name">( std::string_view{ first } ) );
+    auto const w = create_struct( make_member<"id">( 1 ), make_member<"name">( std::string_view{ second } ) );
+    static_assert( !detail::is_bulk_v<std::string_view> && detail::is_bulk_v<std::array<int, 3>> && !detail::is_bulk_v<double> );
+    check( v == w && hash_struct( v ) == hash_struct( w ), "views compared and hashed by what they refer to" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// counts the allocations reaching the heap through it
+struct counting_resource : std::pmr::memory_resource
+{
+    std::size_t allocations = 0;
+
+    void* do_allocate( std::size_t bytes, std::size_t alignment ) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate( bytes, alignment );
+    }
+    void do_deallocate( void* p, std::size_t bytes, std::size_t alignment ) override { std::pmr::new_delete_resource()->deallocate( p, bytes, alignment ); }
+    bool do_is_equal( std::pmr::memory_resource const& other ) const noexcept override { return this == &other; }
+};
+
+void test_pmr()
+{
+    std::cout << std::endl << "test PMR" << std::endl;
+    using namespace meta;
+
+    counting_resource heap;
+    struct_arena arena{ 16 * 1024, &heap };
+    std::pmr::memory_resource* const default_resource = std::pmr::set_default_resource( &heap );
+    std::size_t const before = heap.allocations;
+    bool in_arena = true, operated_in_arena = true;
+    for ( int request = 0; request != 100; ++request )
+    {
+        auto const s = create_struct( std::allocator_arg, &arena, make_member<"path">( std::pmr::string( 40, 'p' ) ), make_member<"id">( request ),
+                                      make_member<"tags">( std::pmr::vector<std::pmr::string>{ std::pmr::string( 40, 'a' ), std::pmr::string( 40, 'b' ) } ),
+                                      make_member<"inner">( create_struct( make_member<"body">( std::pmr::string( 100, 'b' ) ) ) ) );
+        in_arena = in_arena && s.read<"path">().get_allocator().resource() == &arena && s.read<"tags">().get_allocator().resource() == &arena &&
+                              s.read<"tags">()[1].get_allocator().resource() == &arena && s.read<"inner">().read<"body">().get_allocator().resource() == &arena;
+        auto const t = update_struct<"path">( std::allocator_arg, &arena, s, std::pmr::string( 50, 'q' ) );
+        auto const u = update_struct<"status">( std::allocator_arg, &arena, t, std::pmr::string( 30, 's' ) );
+        in_arena = in_arena && t.read<"path">().get_allocator().resource() == &arena && t.read<"tags">()[0].get_allocator().resource() == &arena &&
+                                      u.read<"status">().get_allocator().resource() == &arena && u.read<"inner">().read<"body">().get_allocator().resource() == &arena;
+        // the copy constructor would allocate from the default resource
+        auto const copied = copy_struct( std::allocator_arg, &arena, u );
+        in_arena = in_arena && copied == u;
+        if ( request == 0 )
+            std::cout << "bytes: " << arena.allocated() << std::endl;
+
+        // the other operations stay in the arena, and allocate nothing from the default resource
+        std::size_t const operations_before = heap.allocations;
+        auto const stays_in_arena = [&]( auto const& x )
+        {
+            return x.template read<"path">().get_allocator().resource() == &arena && x.template read<"tags">()[0].get_allocator().resource() == &arena &&
+                   x.template read<"inner">().template read<"body">().get_allocator().resource() == &arena;
+        };
+        auto const deleted = delete_struct<"status">( std::allocator_arg, &arena, u );
+        auto const upgraded = upgrade_struct<"id">( std::allocator_arg, &arena, deleted, request + 1 );
+        auto const fields = update_fields( std::allocator_arg, &arena, upgraded, make_member<"id">( request + 2 ), make_member<"retries">( 0 ) );
+        auto const joined = concatenate_struct( std::allocator_arg, &arena, create_struct( make_member<"method">( 'G' ) ), fields );
+        auto const members = joined.update<"id">( std::allocator_arg, &arena, 0 ).upgrade<"method">( std::allocator_arg, &arena, 'P' ).destroy<"retries">( std::allocator_arg, &arena );
+        operated_in_arena = operated_in_arena && heap.allocations == operations_before && stays_in_arena( deleted ) && stays_in_arena( upgraded ) && stays_in_arena( fields ) && stays_in_arena( joined ) && stays_in_arena( members ) &&
+                                       !deleted.has<"status">() && upgraded.read<"id">() == request + 1 && fields.read<"id">() == request + 2 && members.size() == 5;
+        arena.reset();
+    }
+    // only the temporaries the fields are created from use the default resource: the path, the initializer list of tags, the vector of tags and its 2 strings,
+    // the body and the 2 updates
+    std::size_t const heap_allocations = heap.allocations - before;
+    std::pmr::set_default_resource( default_resource );
+    check( in_arena, "created, updated and copied in the arena" );
+    check( operated_in_arena, "other operations in the arena" );
+    std::cout << "arena allocations: " << arena.peak() << " bytes at most" << std::endl;
+    check( heap_allocations == 100 * 9, "only the temporaries on the heap" );
+
+    // the arena grows into its upstream, then shrinks back at reset
+    std::size_t total = 0;
+    for ( int index = 0; index != 100; ++index )
+        total += create_struct( std::allocator_arg, &arena, make_member<"big">( std::pmr::string( 1024, 'x' ) ) ).read<"big">().size();
+    check( arena.allocated() > arena.capacity() && total == 100 * 1024, "arena grown" );
+    arena.reset();
+
+    // an arena which runs out of memory throws std::bad_alloc out of every operation
+    std::array<std::byte, 256> storage;
+    std::pmr::monotonic_buffer_resource bounded{ storage.data(), storage.size(), std::pmr::null_memory_resource() };
+    struct_arena small{ 64, &bounded };
+    auto const source = create_struct( make_member<"id">( 1 ), make_member<"text">( std::pmr::string( 200, 't' ) ) );
+    auto const other = create_struct( make_member<"more">( std::pmr::string( 200, 'm' ) ) );
+    std::size_t failures = 0;
+    auto const fails = [&]( auto&& operation )
+    {
+        small.reset();
+        try { operation(); }
+        catch ( std::bad_alloc const& ) { ++failures; }
+    };
+    fails( [&]() { create_struct( std::allocator_arg, &small, make_member<"text">( std::pmr::string( 200, 'c' ) ) ); } );
+    fails( [&]() { copy_struct( std::allocator_arg, &small, source ); } );
+    fails( [&]() { update_struct<"id">( std::allocator_arg, &small, source, 2 ); } );
+    fails( [&]() { upgrade_struct<"id">( std::allocator_arg, &small, source, 2 ); } );
+    fails( [&]() { delete_struct<"id">( std::allocator_arg, &small, source ); } );
+    fails( [&]() { update_fields( std::allocator_arg, &small, source, make_member<"id">( 2 ) ); } );
+    fails( [&]() { concatenate_struct( std::allocator_arg, &small, source, other ); } );
+    fails( [&]() { source.update<"id">( std::allocator_arg, &small, 2 ); } );
+    check( failures == 8, "every operation fails with bad_alloc" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// serialize
+void test_serialize()
+{
+    std::cout << std::endl << "test SERIALIZE" << std::endl;
+    using namespace meta;
+
+    auto const s = create_struct( make_member<"id">( 42 ), make_member<"weight">( 1.5 ), make_member<"name">( std::string{"meta"} ),
+                                  make_member<"values">( std::vector<int>{ 1, 2, 3 } ), make_member<"flag">( 'y' ) );
+    using S = std::remove_cvref_t<decltype(s)>;
+    using R = std::remove_cvref_t<decltype(s.update<"id">( 1L ))>;
+    static_assert( detail::wire_schema_of<S>::fingerprint != detail::wire_schema_of<R>::fingerprint );
+
+    std::vector<std::byte> const buffer = serialize_struct( s );
+    std::cout << "serialized " << buffer.size() << " bytes" << std::endl;
+
+    auto const view = view_struct<S>( std::span{ buffer } );
+    check( view.has_value(), "buffer viewed" );
+    std::cout << "id: " << view->read<"id">() << ", weight: " << view->read<"weight">() << ", name: " << view->read<"name">() << ", flag: " << view->read<"flag">() << ", values:";
+    for ( int value : view->read<"values">() )
+        std::cout << " " << value;
+    std::cout << std::endl;
+
+    S const t = view->to_struct();
+    check( t.read<"name">() == s.read<"name">() && t.read<"values">() == s.read<"values">() && t.read<"id">() == 42 && t.read<"flag">() == 'y', "round trip" );
+    check( !view_struct<S>( std::span{ buffer }.first( buffer.size() - 1 ) ), "truncated buffer rejected" );
+    check( !view_struct<R>( std::span{ buffer } ), "other schema rejected" );
+
+    // addresses are not values: views and pointers cannot be serialized, nested structures of values can
+    static_assert( !detail::is_raw_wire<std::string_view>() && !detail::is_raw_wire<std::span<int const>>() && !detail::is_raw_wire<int*>() );
+    static_assert( !detail::is_raw_wire<decltype(create_struct( make_member<"name">( std::string_view{} ) ))>() );
+    auto const nested = create_struct( make_member<"origin">( create_struct( make_member<"x">( 1.5 ), make_member<"y">( -2 ) ) ), make_member<"tags">( std::array<char, 3>{ 'a', 'b', 'c' } ) );
+    std::vector<std::byte> const nested_buffer = serialize_struct( nested );
+    auto const nested_view = view_struct<std::remove_cvref_t<decltype(nested)>>( std::span{ nested_buffer } );
+    check( nested_view && nested_view->read<"origin">().read<"x">() == 1.5 && nested_view->read<"origin">().read<"y">() == -2 && nested_view->read<"tags">()[2] == 'c', "nested" );
+
+    // a bool is read only if its byte is 0 or 1, an unscoped enum may have no value for some bytes and is not serialized
+    enum class level : std::uint8_t { low, high };
+    enum plain { a, b };
+    static_assert( detail::is_raw_wire<level>() && !detail::is_raw_wire<plain>() );
+    auto const flags = create_struct( make_member<"on">( true ), make_member<"level">( level::high ), make_member<"inner">( create_struct( make_member<"id">( 1 ), make_member<"off">( false ) ) ),
+                                      make_member<"pair">( std::array<bool, 2>{ true, false } ) );
+    using F = std::remove_cvref_t<decltype(flags)>;
+    std::vector<std::byte> const flags_buffer = serialize_struct( flags );
+    auto const corrupted = [&]( std::size_t offset )
+    {
+        std::vector<std::byte> bytes = flags_buffer;
+        bytes[offset] = std::byte{ 2 };
+        return !view_struct<F>( std::span{ bytes } ).has_value();
+    };
+    constexpr auto offsets = detail::wire_schema_of<F>::offsets;
+    bool const bools_checked = view_struct<F>( std::span{ flags_buffer } ).has_value() && corrupted( offsets[0] ) && !corrupted( offsets[1] ) &&
+                               corrupted( offsets[2] + offset_of<"off">( flags.read<"inner">() ) ) && corrupted( offsets[3] + 1 );
+    auto const flag_patch = serialize_patch( diff_struct( flags, flags.update<"on">( false ) ) );
+    std::vector<std::byte> bad_patch = flag_patch;
+    bad_patch.back() = std::byte{ 7 };
+    bool const patch_checked = deserialize_patch<F>( std::span{ flag_patch } ).has_value() && !deserialize_patch<F>( std::span{ bad_patch } ).has_value();
+    check( bools_checked, "corrupted bools rejected" );
+    check( patch_checked, "corrupted bool in a patch rejected" );
+    std::cout << "---------------------------------------------------------\n";
+}
+
+// json
+void test_json()
+{
+    std::cout << std::endl << "test JSON" << std::endl;
+    using namespace meta;
+
+    auto const point = create_struct( make_member<"x">( 0.0 ), make_member<"y">( 0.0 ) );
+    auto const s = create_struct( make_member<"id">( 42 ), make_member<"name">( std::string{"say \"hi\"\n"} ), make_member<"ok">( true ),
+                                  make_member<"values">( std::vector<int>{ 1, -2, 3 } ), make_member<"at">( point.update<"x">( 0.1 ).update<"y">( -2.5e10 ) ) );
+    using S = std::remove_cvref_t<decltype(s)>;
+
+    std::string const json = to_json( s );
+    std::cout << json << std::endl;
+
+    auto const t = from_json<S>( json );
+    check( t && to_json( *t ) == json, "round trip" );
+
+    auto const u = from_json<S>( R"( { "extra": [ {"a": "]}"}, null ], "name": "caf\u00e9 \ud83d\ude00", "id": -7, "at": { "y": 1e3 } } )" );
+    check( u && u->read<"id">() == -7 && u->read<"name">() == "caf\xc3\xa9 \xf0\x9f\x98\x80" && u->read<"at">().read<"y">() == 1000.0 && u->read<"values">().empty(), "reordered, unknown and missing keys" );
+
+    for ( std::string_view bad : { R"({"id": 1.5})", R"({"id": 01})", R"({"id": "1"})", R"({"ok": 1})", R"({"id": 1,})", R"({"id": 1} x)", R"({"name": "abc)" } )
+        check( !from_json<S>( bad ), std::string{ bad } + " rejected" );
+
+    // malformed numbers, and malformed values of unknown keys, are rejected too
+    std::size_t accepted = 0;
+    for ( std::string_view bad : { R"({"at": {"x": .5}})", R"({"at": {"x": 1.}})", R"({"at": {"x": 1e}})", R"({"at": {"x": -}})", R"({"at": {"x": inf}})", R"({"id": +1})",
+                                   R"({"extra": tru})", R"({"extra": nul})", R"({"extra": [}})", R"({"extra": {]})", R"({"extra": [1 2]})", R"({"extra": {"a" 1}})",
+                                   R"({"extra": .5})", R"({"extra": 01})", R"({"extra": "\x"})", R"({"extra": [1,]})" } )
+        accepted += from_json<S>( bad ).has_value();
+    std::string const deep = R"({"extra": )" + std::string( 100000, '[' ) + std::string( 100000, ']' ) + "}";
+    bool const valid = from_json<S>( R"({"extra": [true, false, null, -0.5e-3, {"a": [{}], "b": "\u00e9 \\n"}], "at": {"x": 0.25, "y": -1E+2}})" ).has_value();
+    check( accepted == 0, "malformed values rejected" );
+    check( !from_json<S>( deep ), "too deep rejected" );
+    check( valid, "valid unknown values accepted" );
+    std::cout << "---------------------------------------------------------\n";
+}
+// csv
+void test_csv()
+{
+    std::cout << std::endl << "test CSV" << std::endl;
+    using namespace meta;
+
+    auto const prototype = create_struct( make_member<"id">( 0 ), make_member<"name">( std::string{} ), make_member<"price">( 0.0 ), make_member<"active">( false ) );
+    using S = std::remove_cvref_t<decltype(prototype)>;
+
+    // columns in another order, an unknown column, a missing field, quotes and CRLF
+    soa_vector<S> v;
+    csv_result const result = parse_csv( "price,unused,id,name\r\n1.5,x,1,plain\r\n\r\n2.25,\"a,b\",2,\"say \"\"hi\"\"\nbye\"\r\n,,3,\r\n", v );
+    for ( std::size_t index = 0; index < v.size(); ++index )
+        std::cout << v[index].read<"id">() << " [" << v[index].read<"name">() << "] " << v[index].read<"price">() << " " << v[index].read<"active">() << std::endl;
+    check( result && result.rows == 3 && v[1].read<"name">() == "say \"hi\"\nbye" && v[2].read<"price">() == 0.0, "rows parsed" );
+
+    soa_vector<S> w;
+    csv_result const bad = parse_csv( "id,price\n1,2\n\n3,x\n4,5\n", w );
+    check( !bad && bad.record == 4 && bad.rows == 1, "bad field reported" );
+
+    // a file read in small chunks, by one and by four threads, matches the text parsed at once
+    std::string text = "id,name,price,active\n";
+    for ( int index = 0; index < 5000; ++index )
+        text += std::to_string( index ) + ",\"row, " + std::to_string( index ) + "\"," + std::to_string( index * 0.5 ) + "," + ( index % 2 ? "true" : "0" ) + "\n";
+    std::filesystem::path const path = std::filesystem::temp_directory_path() / "meta_structure_test.csv";
+    std::ofstream( path ) << text;
+
+    soa_vector<S> all, chunked, threaded;
+    parse_csv( text, all );
+    csv_result const chunked_result = load_csv( path, chunked, csv_options{ .chunk_size = 1000, .batch_rows = 64 } );
+    csv_result const threaded_result = load_csv( path, threaded, csv_options{ .chunk_size = 16384, .threads = 4 } );
+    std::filesystem::remove( path );
+
+    auto const same = [&]( soa_vector<S> const& x )
+    {
+        return x.size() == all.size() && std::ranges::equal( x.col<"id">(), all.col<"id">() ) && std::ranges::equal( x.col<"name">(), all.col<"name">() ) &&
+               std::ranges::equal( x.col<"price">(), all.col<"price">() ) && std::ranges::equal( x.col<"active">(), all.col<"active">() );
+    };
+    check( all.size() == 5000 && chunked_result && same( chunked ), "read in chunks" );
+    check( threaded_result && same( threaded ), "read by four threads" );
+    check( !load_csv( "/nonexistent/meta.csv", w ), "missing file reported" );
+    std::cout << "---------------------------------------------------------\n";
+}
 int main()
 {
     test_create();
@@ -206,6 +1149,27 @@ int main()
 
     test_polymorphism();
     test_upgrade();
+    test_move();
+    test_storage();
+    test_pack();
+    test_soa_vector();
+    test_wide();
+    test_tag();
+    test_visit();
+    test_fields();
+    test_lazy();
+    test_mutable();
+    test_fold();
+    test_parallel();
+    test_atomic();
+    test_any();
+    test_computed();
+    test_patch();
+    test_compare();
+    test_pmr();
+    test_serialize();
+    test_json();
+    test_csv();
 
     return 0;
 }